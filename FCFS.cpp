@@ -2,6 +2,9 @@
 #include <cstdlib>
 #include <iostream>
 #include <queue>
+#include "gantt.h"
+#include "profile.h"
+#include "report.h"
 using namespace std;
 
 class process {
@@ -67,6 +70,8 @@ priority_queue<process> FCFS_run(priority_queue<process> ready_queue,
 	process p;
 	time_t clock = 0;
 
+	PROFILE_START();
+	PROFILE_HIGH(waitingHighWater, ready_queue.size());
 	// Till ready queue is not empty
 	while (!ready_queue.empty()) {
 
@@ -75,21 +80,28 @@ priority_queue<process> FCFS_run(priority_queue<process> ready_queue,
 		while (clock < ready_queue.top().AT) {
 			p.temp_BT++;
 			clock++;
+			PROFILE_COUNT(idleCycles);
 		}
 		if (p.temp_BT > 0) {
 			p.p_no = -1;
 			p.CT = clock;
 			(*gantt).push(p);
 		}
+		PROFILE_LAP(PHASE_WAITS);
 		p = ready_queue.top();
 		ready_queue.pop();
+		PROFILE_COUNT(arrivals);
+		PROFILE_LAP(PHASE_ARRIVALS);
 		p.set_RT(clock);
+		PROFILE_COUNT(dispatches);
 		while (p.BT_left > 0) {
 			p.temp_BT++;
 			p.BT_left--;
 			clock++;
 		}
 		p.set_CT(clock);
+		PROFILE_COUNT(completions);
+		PROFILE_LAP(PHASE_CPU);
 
 		// Update the Gantt Chart
 		(*gantt).push(p);
@@ -98,7 +110,9 @@ priority_queue<process> FCFS_run(priority_queue<process> ready_queue,
 		// Update the completion time to
 		// the queue
 		completion_queue.push(p);
+		PROFILE_LAP(PHASE_SORT);
 	}
+	PROFILE_HIGH(cycles, clock);
 	return completion_queue;
 }
 
@@ -196,146 +210,95 @@ double get_total_RT(priority_queue<process> processes)
 	return total;
 }
 
+// Hands report output to the ostream in ctx
+void reportToStream(const char *data, size_t n, void *ctx)
+{
+	((ostream *)ctx)->write(data, n);
+}
+
+const report_column completionColumns[] = {
+	{ "process", " Process No. ", 13 },
+	{ "arrival", " Arrival Time ", 14 },
+	{ "burst", " Burst Time ", 12 },
+	{ "completion", " Completion Time ", 17 },
+	{ "turnaround", " Turnaround Time ", 17 },
+	{ "waiting", " Waiting Time ", 14 },
+	{ "response", " Response Time ", 15 },
+	{ "priority", " Priority ", 10 }
+};
+
 // Function to display Completion Queue and
-// all the time
+// all the time, boxed unless REPORT_FORMAT
+// asks for CSV or JSON
 void disp(priority_queue<process> main_queue, bool high)
 {
-	int i = 0, temp, size = main_queue.size();
+	int size = main_queue.size();
 	priority_queue<process> tempq = main_queue;
 	double temp1;
-	cout << "+-------------+--------------";
-	cout << "+------------+-----------------";
-	cout << "+-----------------+--------------+---------------+";
-	if (high == true)
-		cout << "----------+" << endl;
-	else
-		cout << endl;
-	cout << "| Process No. | Arrival Time ";
-	cout << "| Burst Time | Completion Time ";
-	cout << "| Turnaround Time | Waiting Time | Response Time |";
-	if (high == true)
-		cout << " Priority |" << endl;
-	else
-		cout << endl;
-	cout << "+-------------+--------------";
-	cout << "+------------+-----------------";
-	cout << "+-----------------+--------------+---------------+";
-	if (high == true)
-		cout << "----------+" << endl;
-	else
-		cout << endl;
+	report out;
+	report_begin(&out, reportToStream, &cout, "FCFS",
+		completionColumns, high ? 8 : 7, REPORT_BOXED);
 	while (!main_queue.empty()) {
-		temp = to_string(main_queue.top().p_no).length();
-		cout << '|' << string(6 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().p_no << string(7 - temp / 2, ' ');
-		temp = to_string(main_queue.top().start_AT).length();
-		cout << '|' << string(7 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().start_AT << string(7 - temp / 2, ' ');
-		temp = to_string(main_queue.top().BT).length();
-		cout << '|' << string(6 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().BT << string(6 - temp / 2, ' ');
-		temp = to_string(main_queue.top().CT).length();
-		cout << '|' << string(8 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().CT << string(9 - temp / 2, ' ');
-		temp = to_string(main_queue.top().TAT).length();
-		cout << '|' << string(8 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().TAT << string(9 - temp / 2, ' ');
-		temp = to_string(main_queue.top().WT).length();
-		cout << '|' << string(7 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().WT << string(7 - temp / 2, ' ');
-		temp = to_string(main_queue.top().RT).length();
-		cout << '|' << string(7 - temp / 2 - temp % 2, ' ')
-			<< main_queue.top().RT << string(8 - temp / 2, ' ');
-		if (high == true) {
-			temp = to_string(main_queue.top().priority).length();
-			cout << '|' << string(5 - temp / 2 - temp % 2, ' ')
-				<< main_queue.top().priority << string(5 - temp / 2, ' ');
-		}
-		cout << "|\n";
+		report_int(&out, main_queue.top().p_no);
+		report_int(&out, main_queue.top().start_AT);
+		report_int(&out, main_queue.top().BT);
+		report_int(&out, main_queue.top().CT);
+		report_int(&out, main_queue.top().TAT);
+		report_int(&out, main_queue.top().WT);
+		report_int(&out, main_queue.top().RT);
+		if (high == true)
+			report_int(&out, main_queue.top().priority);
 		main_queue.pop();
 	}
-	cout << "+-------------+--------------";
-	cout << "+------------+-----------------";
-	cout << "+-----------------+--------------+---------------+";
-	if (high == true)
-		cout << "----------+";
-	cout << endl;
 	temp1 = get_total_CT(tempq);
-	cout << "\nTotal completion time :- " << temp1
-		<< endl;
-	cout << "Average completion time :- " << temp1 / size
-		<< endl;
+	report_value_real(&out, "total_completion",
+		"\nTotal completion time :- ", temp1, -1);
+	report_value_real(&out, "average_completion",
+		"Average completion time :- ", temp1 / size, -1);
 	temp1 = get_total_TAT(tempq);
-	cout << "\nTotal turnaround time :- " << temp1
-		<< endl;
-	cout << "Average turnaround time :- " << temp1 / size
-		<< endl;
+	report_value_real(&out, "total_turnaround",
+		"\nTotal turnaround time :- ", temp1, -1);
+	report_value_real(&out, "average_turnaround",
+		"Average turnaround time :- ", temp1 / size, -1);
 	temp1 = get_total_WT(tempq);
-	cout << "\nTotal waiting time :- " << temp1
-		<< endl;
-	cout << "Average waiting time :- " << temp1 / size
-		<< endl;
+	report_value_real(&out, "total_waiting",
+		"\nTotal waiting time :- ", temp1, -1);
+	report_value_real(&out, "average_waiting",
+		"Average waiting time :- ", temp1 / size, -1);
 	temp1 = get_total_RT(tempq);
-	cout << "\nTotal response time :- " << temp1
-		<< endl;
-	cout << "Average response time :- " << temp1 / size
-		<< endl;
+	report_value_real(&out, "total_response",
+		"\nTotal response time :- ", temp1, -1);
+	report_value_real(&out, "average_response",
+		"Average response time :- ", temp1 / size, -1);
+	report_end(&out);
+	if (report_human(&out)) {
+		cout << endl;
+		printProfile(cout, "FCFS");
+	}
+#ifndef NO_PROFILE
+	else
+		appendProfileJSON("FCFS");
+#endif
+	cout << flush;
 }
 
 // Function to display Gantt Chart
+// Slices are streamed to the renderer, which
+// merges and scales them to the terminal width
 void disp_gantt_chart(queue<process> gantt)
 {
-	int temp, prev = 0;
-	queue<process> spaces = gantt;
-	cout << "\n\nGantt Chart (IS indicates ideal state) :- \n\n+";
-
-	// For 1st row of gantt chart
-	while (!spaces.empty()) {
-		cout << string(to_string(spaces.front().p_no).length()
-						+ (spaces.front().p_no != -1)
-						+ 2 * spaces.front().temp_BT,
-					'-')
-			<< "+";
-		spaces.pop();
-	}
-	cout << "\n|";
-	spaces = gantt;
-
-	// For process no. in 2nd row
-	while (!spaces.empty()) {
-		cout << string(spaces.front().temp_BT, ' ');
-		if (spaces.front().p_no == -1)
-			cout << "IS" << string(spaces.front().temp_BT, ' ') << '|';
-		else
-			cout << "P" << spaces.front().p_no
-				<< string(spaces.front().temp_BT, ' ') << '|';
-		spaces.pop();
-	}
-	spaces = gantt;
-	cout << "\n+";
-
-	while (!spaces.empty()) {
-		cout << (string(to_string(spaces.front().p_no).length()
-							+ (spaces.front().p_no != -1)
-							+ 2 * spaces.front().temp_BT,
-						'-'))
-			<< "+";
-		spaces.pop();
-	}
-	spaces = gantt;
-	cout << "\n0";
-//For 3rd row of gantt chart
-	while (!spaces.empty()) {
-		temp = to_string(spaces.front().CT).length();
-		cout << (string(to_string(spaces.front().p_no).length()
-							+ (spaces.front().p_no != -1)
-							+ 2 * spaces.front().temp_BT - temp / 2 - prev,
-						' '))
-			<< spaces.front().CT;
-		prev = temp / 2 - temp % 2 == 0;
-		spaces.pop();
+	struct gantt chart;
+	time_t total = gantt.empty() ? 0 : gantt.back().CT;
+	cout << "\n\nGantt Chart (IS indicates ideal state) :- \n\n" << flush;
+	gantt_begin(&chart, stdout, total);
+	while (!gantt.empty()) {
+		gantt_add(&chart, gantt.front().p_no,
+				gantt.front().CT - gantt.front().temp_BT,
+				gantt.front().CT);
+		gantt.pop();
 	}
-	cout << "\n\n";
+	gantt_end(&chart);
+	fflush(stdout);
 }
 
 // Driver Code
@@ -350,12 +313,14 @@ int main()
 	ready_queue = set_sample_data();
 
 	// Function call for completion data
+	profileReset();
 	completion_queue = FCFS_run(ready_queue, &gantt);
 
 	// Display Completion Queue
 	disp(completion_queue, false);
 
 	// Display Gantt Chart
-	disp_gantt_chart(gantt);
+	if (report_format() == REPORT_TABLE)
+		disp_gantt_chart(gantt);
 	return 0;
 }
@@ -1,5 +1,7 @@
 #include<stdio.h>
 #include<stdlib.h>
+#include "gantt.h"
+#include "report.h"
 
 
 
@@ -27,6 +29,18 @@ void b_sort(processes temp[],int n)
 		}
 }
 
+// Name of process id in the Gantt chart, ctx is the process array
+const char *process_name(int id, void *ctx){
+	return ((processes *)ctx)[id].name;
+}
+
+int total_bt(processes temp[],int n){
+	int i,total=0;
+	for(i=0;i<n;i++)
+		total+=temp[i].bt;
+	return total;
+}
+
 int accept(processes P[]){
     system("cls");
 	int i,n;
@@ -54,61 +68,148 @@ int accept(processes P[]){
 
 }
 
-// FCFS Algorithm
-void FCFS(processes P[],int n){
-	processes temp[10];
+// Waiting and turn-around times of a non pre-emptive order,
+// every process runs as soon as the one before it finishes
+void NP_times(processes temp[],int n){
+	int i;
+	temp[0].wt = 0;
+	temp[0].ta = temp[0].bt - temp[0].at;
+	for(i=1;i<n;i++){
+		temp[i].wt = (temp[i-1].bt + temp[i-1].at + temp[i-1].wt) - temp[i].at;;
+		temp[i].ta = (temp[i].wt + temp[i].bt);
+	}
+}
+
+static const struct report_column order_columns[] = {
+	{"process", "PROC.", 0}, {"burst", "B.T.", 0}, {"arrival", "A.T.", 0},
+	{"waiting", "W.T", 0}, {"turnaround", "T.A.T", 0}
+};
+
+// Table, Gantt chart and averages of a non pre-emptive order,
+// the table and averages alone as CSV or JSON if REPORT_FORMAT says so
+void NP_print(processes temp[],int n){
 	int sumw=0,sumt=0;
 	int x = 0;
+	struct gantt chart;
+	struct report out;
 	float avgwt=0.0,avgta=0.0;
-	int i,j;
-	for(i=0;i<n;i++)
-		temp[i]=P[i];
-
-	b_sort(temp,n);
-
-		printf("\n\n PROC.\tB.T.\tA.T.");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at);
-
-		sumw = temp[0].wt = 0;
-		sumt = temp[0].ta = temp[0].bt - temp[0].at;
+	int i;
+
+		report_begin(&out, report_file_write, stdout, "order", order_columns, 5, REPORT_TABS);
+		out.row_begin = "\n ";
+		out.row_end = "";
+		out.value_end = "";
+		if(report_human(&out)){
+			printf("\n\n PROC.\tB.T.\tA.T.");
+			for(i=0;i<n;i++)
+				printf("\n %s\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at);
+		}
 
-		for(i=1;i<n;i++){
-			temp[i].wt = (temp[i-1].bt + temp[i-1].at + temp[i-1].wt) - temp[i].at;;
-			temp[i].ta = (temp[i].wt + temp[i].bt);
+		for(i=0;i<n;i++){
 			sumw+=temp[i].wt;
 			sumt+=temp[i].ta;
 		}
 		avgwt = (float)sumw/n;
 		avgta = (float)sumt/n;
-		printf("\n\n PROC.\tB.T.\tA.T.\tW.T\tT.A.T");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at,temp[i].wt,temp[i].ta);
-
-		printf("\n\n GANTT CHART\n ");
-		for(i=0;i<n;i++)
-			printf("   %s   ",temp[i].name);
-		printf("\n ");
-
-		printf("0\t");
-		for(i=1;i<=n;i++){
-			x+=temp[i-1].bt;
-			printf("%d      ",x);
+		report_title(&out, "\n");
+		for(i=0;i<n;i++){
+			report_text(&out, temp[i].name);
+			report_int(&out, temp[i].bt);
+			report_int(&out, temp[i].at);
+			report_int(&out, temp[i].wt);
+			report_int(&out, temp[i].ta);
+		}
+
+		if(report_human(&out)){
+			report_flush(&out);
+			printf("\n\n GANTT CHART\n\n");
+			gantt_begin(&chart, stdout, total_bt(temp,n));
+			chart.label = process_name;
+			chart.ctx = temp;
+			for(i=0;i<n;i++){
+				gantt_add(&chart, i, x, x + temp[i].bt);
+				x+=temp[i].bt;
+			}
+			gantt_end(&chart);
 		}
-		printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
+		report_value_real(&out, "average_waiting", "\n\n Average waiting time = ", avgwt, 2);
+		report_value_real(&out, "average_turnaround", "\n Average turn-around = ", avgta, 2);
+		report_end(&out);
+		if(report_human(&out))
+			printf(".");
 		printf("\n");
 		printf("\n");
 		system("pause");
 }
 
+// Gantt chart a pre-emptive algorithm draws its slices on, NULL when
+// REPORT_FORMAT asks for CSV or JSON and the chart is left out
+struct gantt *P_chart(struct gantt *chart,processes P[],int n,processes temp[]){
+	if(report_format() != REPORT_TABLE)
+		return NULL;
+	printf("\n GANTT CHART\n\n");
+	gantt_begin(chart, stdout, total_bt(P,n));
+	chart->label = process_name;
+	chart->ctx = temp;
+	return chart;
+}
 
-//SJF Non Pre-emptive
-void SJF_NP(processes P[],int n){
-	processes temp[10];
-	processes t;
+// Averages of the times left in temp by a pre-emptive algorithm,
+// with the table of them ahead when REPORT_FORMAT is CSV or JSON
+void P_print(processes temp[],int n){
 	int sumw=0,sumt=0;
-	int x = 0;
+	struct report out;
 	float avgwt=0.0,avgta=0.0;
+	int i;
+	for(i=0;i<n;i++){
+		sumw+=temp[i].wt;
+		sumt+=temp[i].ta;
+	}
+	avgwt = (float)sumw/n;
+	avgta = (float)sumt/n;
+	if(report_format() == REPORT_TABLE)
+		report_begin(&out, report_file_write, stdout, "averages", NULL, 0, REPORT_TABS);
+	else
+		report_begin(&out, report_file_write, stdout, "order", order_columns, 5, REPORT_TABS);
+	out.value_end = "";
+	if(!report_human(&out))
+		for(i=0;i<n;i++){
+			report_text(&out, temp[i].name);
+			report_int(&out, temp[i].bt);
+			report_int(&out, temp[i].at);
+			report_int(&out, temp[i].wt);
+			report_int(&out, temp[i].ta);
+		}
+	report_value_real(&out, "average_waiting", "\n\n Average waiting time = ", avgwt, 2);
+	report_value_real(&out, "average_turnaround", "\n Average turn-around = ", avgta, 2);
+	report_end(&out);
+	if(report_human(&out))
+		printf(".");
+	printf("\n");
+	printf("\n");
+	system("pause");
+}
+
+// FCFS Algorithm
+void FCFS_run(processes P[],int n,processes temp[]){
+	int i;
+	for(i=0;i<n;i++)
+		temp[i]=P[i];
+
+	b_sort(temp,n);
+	NP_times(temp,n);
+}
+
+void FCFS(processes P[],int n){
+	processes temp[10];
+	FCFS_run(P,n,temp);
+	NP_print(temp,n);
+}
+
+
+//SJF Non Pre-emptive
+void SJF_NP_run(processes P[],int n,processes temp[]){
+	processes t;
 	int i,j;
 
 	for(i=0;i<n;i++)
@@ -124,51 +225,20 @@ void SJF_NP(processes P[],int n){
 				temp[j+1] = t;
 			}
 		}
+	NP_times(temp,n);
+}
 
-	printf("\n\n PROC.\tB.T.\tA.T.");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at);
-
-		sumw = temp[0].wt = 0;
-		sumt = temp[0].ta = temp[0].bt - temp[0].at;
-
-		for(i=1;i<n;i++){
-			temp[i].wt = (temp[i-1].bt + temp[i-1].at + temp[i-1].wt) - temp[i].at;;
-			temp[i].ta = (temp[i].wt + temp[i].bt);
-			sumw+=temp[i].wt;
-			sumt+=temp[i].ta;
-		}
-		avgwt = (float)sumw/n;
-		avgta = (float)sumt/n;
-		printf("\n\n PROC.\tB.T.\tA.T.\tW.T\tT.A.T");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at,temp[i].wt,temp[i].ta);
-
-		printf("\n\n GANTT CHART\n ");
-		for(i=0;i<n;i++)
-			printf("   %s   ",temp[i].name);
-		printf("\n ");
-
-		printf("0\t");
-		for(i=1;i<=n;i++){
-			x+=temp[i-1].bt;
-			printf("%d      ",x);
-		}
-		printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
-		printf("\n");
-		printf("\n");
-		system("pause");
+void SJF_NP(processes P[],int n){
+	processes temp[10];
+	SJF_NP_run(P,n,temp);
+	NP_print(temp,n);
 }
 
 //Priority Non Pre-emptive
-void PRT_NP(processes P[],int n)
+void PRT_NP_run(processes P[],int n,processes temp[])
 {
-	processes temp[10];
 	processes t;
-	int sumw=0,sumt=0;
-	float avgwt=0.0,avgta=0.0;
 	int i,j;
-	int x = 0;
 
 	for(i=0;i<n;i++)
 		temp[i]=P[i];
@@ -183,100 +253,81 @@ void PRT_NP(processes P[],int n)
 				temp[j+1] = t;
 			}
 		}
+	NP_times(temp,n);
+}
 
-	printf("\n\n PROC.\tB.T.\tA.T.");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at);
-
-		sumw = temp[0].wt = 0;
-		sumt = temp[0].ta = temp[0].bt - temp[0].at;
-
-		for(i=1;i<n;i++){
-			temp[i].wt = (temp[i-1].bt + temp[i-1].at + temp[i-1].wt) - temp[i].at;;
-			temp[i].ta = (temp[i].wt + temp[i].bt);
-			sumw+=temp[i].wt;
-			sumt+=temp[i].ta;
-		}
-		avgwt = (float)sumw/n;
-		avgta = (float)sumt/n;
-		printf("\n\n PROC.\tB.T.\tA.T.\tW.T\tT.A.T");
-		for(i=0;i<n;i++)
-			printf("\n %s\t%d\t%d\t%d\t%d",temp[i].name,temp[i].bt,temp[i].at,temp[i].wt,temp[i].ta);
-
-		printf("\n\n GANTT CHART\n ");
-		for(i=0;i<n;i++)
-			printf("   %s   ",temp[i].name);
-		printf("\n ");
-
-		printf("0\t");
-		for(i=1;i<=n;i++){
-			x+=temp[i-1].bt;
-			printf("%d      ",x);
-		}
-		printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
-		printf("\n");
-		printf("\n");
-		system("pause");
+void PRT_NP(processes P[],int n)
+{
+	processes temp[10];
+	PRT_NP_run(P,n,temp);
+	NP_print(temp,n);
 }
 
 //Round Robin Scheduling
-void RR(processes P[],int n)
+//slices go to chart unless it is NULL
+void RR_run(processes P[],int n,int Q,processes temp1[],struct gantt *chart)
 {
-	int pflag=0,t,tcurr=0,k,i,Q=0;
-	int sumw=0,sumt=0;
-	float avgwt=0.0,avgta=0.0;
-	processes temp1[10],temp2[10];
+	int pflag=0,t,tcurr=0,k,i;
+	processes temp2[10];
 
-	for(i=0;i<n;i++)
+	for(i=0;i<n;i++){
 		temp1[i]=P[i];
+		temp1[i].flag = 0;
+	}
 
 	b_sort(temp1,n);
 
 	for(i=0;i<n;i++)
 		temp2[i]=temp1[i];
 
-	printf("\n Enter quantum time : ");
-	scanf("%d",&Q);
-
 	for(k=0;;k++){
 		if(k>n-1)
 			k=0;
-		if(temp1[k].bt>0)
-			printf("  %d  %s",tcurr,temp1[k].name);
 		t=0;
 		while(t<Q && temp1[k].bt > 0){
 			t++;
 			tcurr++;
 			temp1[k].bt--;
 		}
+		if(chart != NULL)
+			gantt_add(chart, k, tcurr - t, tcurr);
 		if(temp1[k].bt <= 0 && temp1[k].flag != 1){
 			temp1[k].wt = tcurr - temp2[k].bt - temp1[k].at;
 			temp1[k].ta = tcurr - temp1[k].at;
 			pflag++;
 			temp1[k].flag = 1;
-			sumw+=temp1[k].wt;
-			sumt+=temp1[k].ta;
 		}
 		if(pflag == n)
 			break;
 	}
-	printf("  %d",tcurr);
-	avgwt = (float)sumw/n;
-	avgta = (float)sumt/n;
-	printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
-	printf("\n");
-		system("pause");
+	for(i=0;i<n;i++)
+		temp1[i].bt = temp2[i].bt;
+}
+
+void RR(processes P[],int n)
+{
+	int Q=0;
+	processes temp1[10];
+	struct gantt chart,*drawn;
+
+	printf("\n Enter quantum time : ");
+	scanf("%d",&Q);
+
+	drawn = P_chart(&chart,P,n,temp1);
+	RR_run(P,n,Q,temp1,drawn);
+	if(drawn != NULL)
+		gantt_end(drawn);
+	P_print(temp1,n);
 }
 
 //Shortest Job First - Pre-emptive
-void SJF_P(processes P[],int n){
-	int i,t_total=0,tcurr,b[10],min_at,j,x,min_bt;
-	int sumw=0,sumt=0;
-	float avgwt=0.0,avgta=0.0;
-	processes temp[10],t;
+//slices go to chart unless it is NULL
+void SJF_P_run(processes P[],int n,processes temp[],struct gantt *chart){
+	int i,t_total=0,tcurr,b[10],j,x,min_bt;
 
 	for(i=0;i<n;i++){
 		temp[i]=P[i];
+		temp[i].flag = 0;
 		t_total+=P[i].bt;
 	}
 
@@ -286,22 +337,19 @@ void SJF_P(processes P[],int n){
 		b[i] = temp[i].bt;
 
 	i=j=0;
-	printf("\n GANTT CHART\n\n %d %s",i,temp[i].name);
 	for(tcurr=0;tcurr<t_total;tcurr++){
 
-		if(b[i] > 0 && temp[i].at <= tcurr)
+		if(b[i] > 0 && temp[i].at <= tcurr){
 			b[i]--;
-
-		if(i!=j)
-			printf(" %d %s",tcurr,temp[i].name);
+			if(chart != NULL)
+				gantt_add(chart, i, tcurr, tcurr+1);
+		}
 
 		if(b[i]<=0 && temp[i].flag != 1){
 
 			temp[i].flag = 1;
 			temp[i].wt = (tcurr+1) - temp[i].bt - temp[i].at;
 			temp[i].ta = (tcurr+1) - temp[i].at;
-			sumw+=temp[i].wt;
-			sumt+=temp[i].ta;
 		}
 		j=i;	min_bt = 999;
 		for(x=0;x<n;x++){
@@ -316,23 +364,28 @@ void SJF_P(processes P[],int n){
 		}
 
 	}
-	printf(" %d",tcurr);
-	avgwt = (float)sumw/n;	avgta = (float)sumt/n;
-	printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
-	printf("\n");
-	printf("\n");
-		system("pause");
 }
 
+void SJF_P(processes P[],int n){
+	processes temp[10];
+	struct gantt chart,*drawn;
 
-void PRT_P(processes P[],int n){
+	drawn = P_chart(&chart,P,n,temp);
+	SJF_P_run(P,n,temp,drawn);
+	if(drawn != NULL)
+		gantt_end(drawn);
+	P_print(temp,n);
+}
+
+
+//Priority Pre-emptive
+//slices go to chart unless it is NULL
+void PRT_P_run(processes P[],int n,processes temp[],struct gantt *chart){
 	int i,t_total=0,tcurr,b[10],j,x,min_pr;
-	int sumw=0,sumt=0;
-	float avgwt=0.0,avgta=0.0;
-	processes temp[10],t;
 
 	for(i=0;i<n;i++){
 		temp[i]=P[i];
+		temp[i].flag = 0;
 		t_total+=P[i].bt;
 	}
 
@@ -342,23 +395,20 @@ void PRT_P(processes P[],int n){
 		b[i] = temp[i].bt;
 
 	i=j=0;
-	printf("\n GANTT CHART\n\n %d %s",i,temp[i].name);
 	for(tcurr=0;tcurr<t_total;tcurr++)
 	{
 
-		if(b[i] > 0 && temp[i].at <= tcurr)
+		if(b[i] > 0 && temp[i].at <= tcurr){
 			b[i]--;
-
-		if(i!=j)
-			printf(" %d %s",tcurr,temp[i].name);
+			if(chart != NULL)
+				gantt_add(chart, i, tcurr, tcurr+1);
+		}
 
 		if(b[i]<=0 && temp[i].flag != 1)
 		{
 			temp[i].flag = 1;
 			temp[i].wt = (tcurr+1) - temp[i].bt - temp[i].at;
 			temp[i].ta = (tcurr+1) - temp[i].at;
-			sumw+=temp[i].wt;
-			sumt+=temp[i].ta;
 		}
 		j=i;
 		min_pr = 999;
@@ -374,13 +424,17 @@ void PRT_P(processes P[],int n){
 		}
 
 	}
-	printf(" %d",tcurr);
-	avgwt = (float)sumw/n;
-	avgta = (float)sumt/n;
-	printf("\n\n Average waiting time = %0.2f\n Average turn-around = %0.2f.",avgwt,avgta);
-	printf("\n");
-	printf("\n");
-    system("pause");
+}
+
+void PRT_P(processes P[],int n){
+	processes temp[10];
+	struct gantt chart,*drawn;
+
+	drawn = P_chart(&chart,P,n,temp);
+	PRT_P_run(P,n,temp,drawn);
+	if(drawn != NULL)
+		gantt_end(drawn);
+	P_print(temp,n);
 }
 
 
@@ -19,447 +19,572 @@
 * - Process burst times are known in advance, and will
 * be provided during the demo
 */
-#include <iostream>
-#include <string>
-#include <queue>
-#include <fstream>
-#include <vector>
-#include <algorithm>
-#include <sstream>
-#include <iterator>
+#include <sys/stat.h>
+#include "engine.h"
+#include "classes.h"
+#include "cluster.h"
+#include "pdes.h"
+#include "replicate.h"
+#include "traceimport.h"
 
 using namespace std;
+using namespace engine;
 
-bool cheating;
-
-// Define Process class
-class Process{
-protected:
-
-	friend ostream &operator<<(ostream &, const Process &);
-
-
+// Batch mode
+// Reads one job per line on stdin and writes one result line per job on
+// stdout, without any prompts. A job is
+//   <algorithm> <workload> [quantum=N|auto] [objective=wait|p99|mixed] [penalty=X] [aging=on|off]
+//               [nodes=N] [placement=random|jsq|p2c|least] [migrate=COST] [seed=S]
+//               [window=W] [threads=N] [tick=US] [trace=FILE] [sink=stats|discard|file:PATH]
+//               [estimate=on|only] [replicate=N] [precision=P] [compare=ALG]
+//               [topology=SxLxMxC] [distance=L2,LLC,SOCKET,REMOTE] [affinity=none|soft|hard|wake]
+//               [numa=F] [balance=naive|aware] [governor=performance|powersave|ondemand|schedutil]
+//               [states=SPEED:POWER,...] [idle=P] [cap=P] [id=TAG]
+// where the algorithm is fcfs, srtf, priority, pp or rr (or 1-5 as in the
+// menu) and the workload is a file path, inline:pid,arrival,burst,priority;...
+// trace:PATH, a scheduler trace imported at US microseconds (1000 by
+// default) per cycle, stream:PATH, a workload file in arrival order
+// read as the run goes instead of up front, or classes:PATH, a workload
+// of process classes (see loadClasses()) whose members are made as the
+// run goes.
+// With quantum=auto, rr first tunes the quantum for the objective (mean
+// wait by default), penalty being the cycles charged per context switch.
+// With nodes=N above 1 the workload runs on a cluster of N nodes, placed
+// by join-shortest-queue unless told otherwise, and migrate=COST lets idle
+// nodes take waiting processes at COST cycles each. window=W runs the
+// cluster in parallel windows of W cycles, on as many threads as the host
+// has cores unless threads=N says otherwise. topology= makes the nodes
+// the cores of a Topology, distance= sets what each distance costs and
+// affinity= is the Affinity of placement and stealing, both only for a
+// run on more than one core. numa=F
+// slows a fully memory bound burst F times away from its home=N (see
+// readNumaFields()), and balance=aware places and steals with that in
+// mind, both only with a topology=.
+// governor= runs a single node job on a Dvfs cpu with the states of
+// states= or defaultStates(), idle=P the power of an idle cycle (50 by
+// default) and cap=P the most power a state may draw, none of the three
+// taken without governor=.
+// trace=FILE exports the run to FILE as Chrome trace-event JSON.
+// sink= hands the completed processes to a CompletionSink instead of
+// keeping them. Streamed, class and sink runs are single node runs with a
+// fixed quantum. An fcfs run of classes with sink=stats or
+// sink=discard is not stepped at all but worked out by runClassesFCFS(),
+// its record adding segments=S, the segments it took.
+// estimate=on adds the queueing estimates of the policy (see
+// estimateQueue()) and their error in percent to the record of a single
+// node run; estimate=only gives the estimates without running the job.
+// replicate=N runs up to N workloads drawn from a model of the workload
+// (see replicate()), seeded from seed=S on, on threads=N threads, until
+// the 95% interval of each metric is within P of its mean (0.05 unless
+// precision=P says otherwise). compare=ALG runs ALG on the same draws and
+// adds the difference of its mean wait from that of the algorithm, which
+// is significant if its interval leaves out 0.
+// Blank lines and lines starting with # are skipped, quit ends the batch.
+// Results are
+//   ok id=TAG policy=rr quantum=2 aging=off processes=N cycles=T avg_wait=W avg_turnaround=A
+//      avg_response=R avg_slowdown=S [dispatches=D preemptions=P sorts=S max_waiting=M engine_ns=E] results=P1:wait:turnaround,...
+//   ok id=TAG policy=rr quantum=2 aging=off sink=stats processes=N cycles=T [segments=S] [avg_wait=W avg_turnaround=A
+//      avg_response=R avg_slowdown=S max_turnaround=M] [dispatches=D ... engine_ns=E]
+//   ok id=TAG policy=rr quantum=2 aging=off processes=N load=L est_wait=W est_turnaround=A estimate_ns=E
+// and estimate=on puts est_wait=W wait_error=E est_turnaround=A turnaround_error=E before results=,
+// governor= puts governor=G energy=E avg_power=P throughput=T there too.
+//   ok id=TAG policy=rr quantum=2 aging=off replications=R converged=yes processes=N wait=W wait_ci=LOW:HIGH
+//      turnaround=A turnaround_ci=LOW:HIGH p50=X p50_ci=LOW:HIGH p99=Z p99_ci=LOW:HIGH
+//      [compare=fcfs diff_wait=D diff_wait_ci=LOW:HIGH significant=yes|no]
+//   ok id=TAG policy=fcfs quantum=0 nodes=N placement=jsq migrate=off window=W processes=N cycles=T migrations=M
+//      avg_wait=W avg_turnaround=A p50=X p90=Y p99=Z max=L per_node=node:busy%:processes:p99,...
+//      [topology=SxLxMxC affinity=soft by_distance=core:N,l2:N,llc:N,socket:N,remote:N]
+//      [numa=F balance=aware numa_cycles=C throughput=T]
+//   error id=TAG message
+// The bracketed profile fields are left out when built with NO_PROFILE.
+// Workload files are parsed once and kept, until the file changes.
 
+class CachedWorkload{
 public:
-
-  Process(){};
-
-  Process(int pidVal, int arrivalVal, int burstVal, int priorityVal){
-		pid = pidVal;
-		arrival = arrivalVal;
-		burst = burstVal;
-		priority = priorityVal;
-		completedCycles = 0;
-		wait = 0;
-	};
-	int pid;
-	int arrival;
-	int burst;
-	int priority;
-	int wait;
-	int turnaround;
-	int completedCycles;
-	bool operator< (const Process &aProcess) const{
-	  return arrival > aProcess.arrival;
-	};
-
-  int remainingCycles(){
-	  return burst - completedCycles;
-	};
-
-  int priorityWithWindchill(){
-    return priority - (UseAging()?(wait/5):0);
-	};
-  static void setUseAging(bool yesNo){ cheating = yesNo; };
-  static bool UseAging(){ return cheating; };
+  time_t modified;
+  vector<Process> arrivals;
 };
 
-// Output for Process class
-ostream& operator<<(ostream& os, const Process &aProcess){
-  os << aProcess.pid << "\t" << aProcess.arrival << "\t" << aProcess.burst << "\t" << aProcess.priority << endl;
-  return os;
-};
+map<string, CachedWorkload> workloadCache;
 
-// Helper methods for ProcessQueue
-void incrementWait(Process& aProcess){
-  aProcess.wait++;
-}
-bool lessRemainingTime(Process a, Process b){
-  return a.remainingCycles() < b.remainingCycles();
-}
+// Algorithm names of batch jobs and records, indexed by policy
+const char* batchNames[] = {"", "fcfs", "srtf", "priority", "pp", "rr"};
 
-bool lessPriority(Process a, Process b){
-  return a.priorityWithWindchill() < b.priorityWithWindchill();
+int parsePolicy(const string& name){
+  for(int i=POLICY_FCFS; i <= POLICY_RR; i++){
+    if(name == batchNames[i] || name == to_string(i)){
+      return i;
+    }
+  }
+  return 0;
 }
 
-// ProcessQueue extends Queue to allow access to private iterator
-class ProcessQueue : public queue<Process> {
-public:
-  void incrementWaits(ProcessQueue& aProcessQueue){
-    for_each(aProcessQueue.c.begin(), aProcessQueue.c.end(), incrementWait);
-  };
+// Looks up or parses the workload of a job, NULL if it cannot be read
+const vector<Process>* jobWorkload(const string& spec, int tickMicros, vector<Process>& inlineArrivals){
+  priority_queue<Process> processes;
+  if(spec.compare(0, 7, "inline:") == 0){
+    string text = spec.substr(7);
+    replace(text.begin(), text.end(), ',', ' ');
+    replace(text.begin(), text.end(), ';', '\n');
+    stringstream ss(text);
+    loadWorkload(ss, processes);
+    inlineArrivals = arrivalOrder(processes);
+    return &inlineArrivals;
+  }
+  bool trace = spec.compare(0, 6, "trace:") == 0;
+  string path = trace?spec.substr(6):spec;
+  // A trace is cached once per tick it was imported at
+  string key = trace?spec + "@" + to_string(tickMicros):spec;
+  struct stat info;
+  if(stat(path.c_str(), &info) != 0 || tickMicros < 1){
+    return NULL;
+  }
+  map<string, CachedWorkload>::iterator cached = workloadCache.find(key);
+  if(cached != workloadCache.end() && cached->second.modified == info.st_mtime){
+    return &cached->second.arrivals;
+  }
+  ifstream inFile(path.c_str());
+  if(!inFile){
+    return NULL;
+  }
+  if(trace){
+    TraceImport import(tickMicros, NULL, &processes);
+    import.read(inFile);
+  }else{
+    loadWorkload(inFile, processes);
+  }
+  CachedWorkload& entry = workloadCache[key];
+  entry.modified = info.st_mtime;
+  entry.arrivals = arrivalOrder(processes);
+  return &entry.arrivals;
+}
 
-  void sortByRemainingTime(ProcessQueue& aProcessQueue){
-    sort(aProcessQueue.c.begin(), aProcessQueue.c.end(),lessRemainingTime);
-  };
+// First process of a workload a run could not finish, NULL if there is none
+const Process* unrunnable(const vector<Process>& arrivals){
+  for(int i=0; i < (int)arrivals.size(); i++){
+    if(!runnable(arrivals[i])){
+      return &arrivals[i];
+    }
+  }
+  return NULL;
+}
 
-  void sortByPriority(ProcessQueue& aProcessQueue){
-    sort(aProcessQueue.c.begin(), aProcessQueue.c.end(),lessPriority);
-  };
-};
+// Profile fields of a record, also appended to PROFILE_JSON
+void printRecordProfile(const string& id, ostream& os){
+#ifndef NO_PROFILE
+  long long engineTime = 0;
+  for(int i=0; i < PHASE_COUNT; i++){
+    engineTime += profileNanoseconds(i);
+  }
+  os << " dispatches=" << profile().dispatches << " preemptions=" << profile().preemptions
+     << " sorts=" << profile().sorts << " max_waiting=" << profile().waitingHighWater << " engine_ns=" << engineTime;
+  appendProfileJSON(id.c_str());
+#endif
+}
 
-// Helper method
-template <class T>
-inline string to_string (const T& t){
-  stringstream ss;
-  ss << t;
-  return ss.str();
+void printRecord(const Simulation& sim, const string& id, ostream& os, bool estimate = false){
+  RunColumns columns;
+  columns.add(sim.completed);
+  metrics_run sums = columns.compute(true)[0];
+  string results;
+  for(int i=0; i < (int)sim.completed.size(); i++){
+    results += (i?",P":"P") + to_string(sim.completed[i].pid) + ":" + to_string(columns.wait[i]) + ":" + to_string(columns.turnaround[i]);
+  }
+  double n = sim.completed.empty()?1:sim.completed.size();
+  os << "ok id=" << id << " policy=" << batchNames[sim.policy] << " quantum=" << sim.timeQuantum
+     << " aging=" << (sim.useAging?"on":"off") << " processes=" << sim.completed.size()
+     << " cycles=" << sim.time << " avg_wait=" << sums.wait / n << " avg_turnaround=" << sums.turnaround / n
+     << " avg_response=" << sums.response / n << " avg_slowdown=" << sums.slowdown / n;
+  printRecordProfile(id, os);
+  if(estimate){
+    QueueEstimate predicted = estimateQueue(fitWorkload(sim.completed), sim.policy);
+    os << " est_wait=" << predicted.wait << " wait_error=" << estimateError(predicted.wait, sums.wait / n)
+       << " est_turnaround=" << predicted.turnaround
+       << " turnaround_error=" << estimateError(predicted.turnaround, sums.turnaround / n);
+  }
+  if(sim.dvfs != NULL){
+    os << " governor=" << governorNames[sim.dvfs->governor] << " energy=" << (long long)(sim.dvfs->energy + 0.5)
+       << " avg_power=" << sim.dvfs->energy / max(1LL, sim.dvfs->cycles)
+       << " throughput=" << 1000.0 * sim.completed.size() / max(1, sim.time);
+  }
+  os << " results=" << results << endl;
 }
 
-// Helper method splits on whitespace
-vector<string> getTokens(string str){
-  string buf; // Have a buffer string
-  stringstream ss(str); // Insert the string into a stream
-  vector<string> tokens; // Create vector to hold our words
-  while (ss >> buf)
-  tokens.push_back(buf);
-  return tokens;
+// Record of the estimates alone, and the time they took
+void printEstimateRecord(const vector<Process>& arrivals, int policy, int timeQuantum, bool aging, const string& id, ostream& os){
+  chrono::steady_clock::time_point start = chrono::steady_clock::now();
+  WorkloadFit fit = fitWorkload(arrivals);
+  QueueEstimate predicted = estimateQueue(fit, policy);
+  long long took = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+  os << "ok id=" << id << " policy=" << batchNames[policy] << " quantum=" << timeQuantum
+     << " aging=" << (aging?"on":"off") << " processes=" << fit.processes << " load=" << fit.load
+     << " est_wait=" << predicted.wait << " est_turnaround=" << predicted.turnaround << " estimate_ns=" << took << endl;
 }
 
-void printResults(vector<Process> processes, ostream& os){
-  os << "Performance Results" << endl;
-  os << "PID\tWait\tTurnaround" << endl;
-  int waitTotal=0;
-  int turnaroundTotal=0;
-  /* cast to int */
-  for(int i=0; i < processes.size(); i++){
-    os << "P" << processes[i].pid << "\t" << processes[i].wait << "\t" << processes[i].wait + processes[i].completedCycles << endl;
-    waitTotal += processes[i].wait;
-    turnaroundTotal += processes[i].wait + processes[i].completedCycles;
+// Record of a run whose completed processes went to a sink, with the
+// averages if stats summed them, and the segments of a bulk class run
+// unless they are negative
+void printSinkRecord(int policy, int timeQuantum, bool aging, long long processes, long long cycles, long long segments,
+                     const string& sinkName, StatsSink* stats, const string& id, ostream& os){
+  os << "ok id=" << id << " policy=" << batchNames[policy] << " quantum=" << timeQuantum
+     << " aging=" << (aging?"on":"off") << " sink=" << sinkName.substr(0, sinkName.find(':'))
+     << " processes=" << processes << " cycles=" << cycles;
+  if(segments >= 0){
+    os << " segments=" << segments;
   }
-  os << "Average Wait Time: " << waitTotal / processes.size() << endl;
-  os << "Average Turnarount Time: " << turnaroundTotal / processes.size() << endl;
+  if(stats != NULL){
+    stats->flush();
+    double n = stats->count?stats->count:1;
+    os << " avg_wait=" << stats->wait / n << " avg_turnaround=" << stats->turnaround / n
+       << " avg_response=" << stats->response / n << " avg_slowdown=" << stats->slowdown / n
+       << " max_turnaround=" << stats->maxTurnaround;
+  }
+  printRecordProfile(id, os);
+  os << endl;
 }
 
-void scheduleFCFS(priority_queue<Process> processes, ostream& os){
-  /* cast to int */
-  int processCount = processes.size();
-  os << "Running the FCFS scheduler..." << endl;
-  ProcessQueue waiting;
-  vector<Process> completed;
-  vector<Process> cpu;
-  int time = 0;
-  os << "Time\tEvent" << endl;
-  while(completed.size() != processCount){
-    string event = "";
-    // Waiting processes wait values incremented
-    waiting.incrementWaits(waiting);
-    // Processes arrive
-    /* added empty check */
-    while(!processes.empty() && processes.top().arrival == time){
-      event = event + "P" + to_string(processes.top().pid) + " arrives; ";
-      waiting.push(processes.top());
-      processes.pop();
-      if(processes.empty()){
-        break;
-      }
-    }
-    if(cpu.empty()){
-    // New process put on cpu
-      if(!waiting.empty()){
-        event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-        cpu.push_back(waiting.front());
-        waiting.pop();
-      }
-    }else{
-      /* cast to int */
-      for(int i=0; i < (int)cpu.size(); i++){
-      // Cpu processes are incremented
-        cpu[i].completedCycles++;
-        // If current process completed
-        if(cpu[i].completedCycles == cpu[i].burst){
-          event = event + "P" + to_string(cpu[i].pid) + " completed; ";
-          completed.push_back(cpu[i]);
-          cpu.erase(cpu.begin() + i);
-          // New process put on cpu
-          if(!waiting.empty()){
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            cpu.push_back(waiting.front());
-            waiting.pop();
-          }
-        }
-      }
-    }
-    // Output events for clock cycle
-    os << time << "\t" << event << endl;
-    // New clock cycle
-    time++;
+// Record of a replication, other being the policy compared with or 0
+void printReplicationRecord(const Replication& replication, int policy, int other, int timeQuantum, bool aging,
+                            int processes, const string& id, ostream& os){
+  os << "ok id=" << id << " policy=" << batchNames[policy] << " quantum=" << timeQuantum
+     << " aging=" << (aging?"on":"off") << " replications=" << replication.runs.size()
+     << " converged=" << (replication.converged?"yes":"no") << " processes=" << processes;
+  for(int m=0; m < 4; m++){
+    const Interval& interval = replication.metrics[m];
+    os << " " << replicaMetricKeys[m] << "=" << interval.mean << " " << replicaMetricKeys[m] << "_ci="
+       << interval.mean - interval.half << ":" << interval.mean + interval.half;
+  }
+  if(other){
+    const Interval& difference = replication.differences[0];
+    os << " compare=" << batchNames[other] << " diff_wait=" << difference.mean
+       << " diff_wait_ci=" << difference.mean - difference.half << ":" << difference.mean + difference.half
+       << " significant=" << (fabs(difference.mean) > difference.half?"yes":"no");
   }
-  os << "******************** End simulation ************************" << endl;
-  printResults(completed, os);
+  os << endl;
 }
 
-void scheduleSRTF(priority_queue<Process> processes, ostream& os){
-  /* cast to int */
-  int processCount = (int)processes.size();
-  os << "Running the SRTF scheduler..." << endl;
-  ProcessQueue waiting;
-  vector<Process> completed;
-  vector<Process> cpu;
-  int time = 0;
-  os << "Time\tEvent" << endl;
-  while(completed.size() != processCount){
-    string event = "";
-    // Waiting processes wait value incremented
-    waiting.incrementWaits(waiting);
-    // Processes arrive
-    /* added empty check */
-    while(!processes.empty() && processes.top().arrival == time){
-      event = event + "P" + to_string(processes.top().pid) + " arrives; ";
-      waiting.push(processes.top());
-      processes.pop();
-    }
-    // Sort waiting list by remaining time
-    waiting.sortByRemainingTime(waiting);
-    if(cpu.empty()){
-      // New process put on cpu
-      if(!waiting.empty()){
-        event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-        cpu.push_back(waiting.front());
-        waiting.pop();
-      }
-    }else{
-      /* cast to int */
-      for(int i=0; i < (int)cpu.size(); i++){
-        // Cpu processes are incremented
-        cpu[i].completedCycles++;
-        if(cpu[i].completedCycles == cpu[i].burst){
-          event = event + "P" + to_string(cpu[i].pid) + " completed; ";
-          completed.push_back(cpu[i]);
-          cpu.erase(cpu.begin()+i);
-          // New process put on cpu
-          if(!waiting.empty()){
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            cpu.push_back(waiting.front());
-            waiting.pop();
-          }
-        }else if(!waiting.empty()){
-          if(cpu[i].remainingCycles() > waiting.front().remainingCycles()){
-            event = event + "P" + to_string(cpu[i].pid) + " taken off CPU; ";
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            waiting.push(cpu[i]);
-            cpu.erase(cpu.begin()+i);
-            cpu.push_back(waiting.front());
-            waiting.pop();
-            waiting.sortByRemainingTime(waiting);
-          }
-        }
-      }
+void printClusterRecord(Cluster& cluster, int timeQuantum, int window, const string& id, ostream& os){
+  vector<Process> all;
+  string perNode;
+  for(int i=0; i < (int)cluster.nodes.size(); i++){
+    ClusterNode& node = cluster.nodes[i];
+    all.insert(all.end(), node.sim.completed.begin(), node.sim.completed.end());
+    perNode += (i?",":"") + to_string(i) + ":" + to_string(cluster.time?100 * node.busyCycles / cluster.time:0)
+               + ":" + to_string(node.sim.completed.size()) + ":" + to_string(summarizeLatency(node.sim.completed).p99);
+  }
+  LatencySummary summary = summarizeLatency(all);
+  os << "ok id=" << id << " policy=" << batchNames[cluster.policy] << " quantum=" << timeQuantum
+     << " nodes=" << cluster.nodes.size() << " placement=" << placementNames[cluster.placement]
+     << " migrate=" << (cluster.migrationCost < 0?"off":to_string(cluster.migrationCost))
+     << " window=" << window
+     << " processes=" << summary.processes << " cycles=" << cluster.time << " migrations=" << cluster.migrations
+     << " avg_wait=" << summary.meanWait << " avg_turnaround=" << summary.meanTurnaround
+     << " p50=" << summary.p50 << " p90=" << summary.p90 << " p99=" << summary.p99 << " max=" << summary.longest
+     << " per_node=" << perNode;
+  const Topology& topology = cluster.topology;
+  if(topology.described || cluster.affinity != AFFINITY_NONE){
+    os << " topology=" << topology.sockets << "x" << topology.llcs << "x" << topology.l2s << "x" << topology.cores
+       << " affinity=" << affinityNames[cluster.affinity] << " by_distance=";
+    for(int d=DISTANCE_CORE; d < DISTANCES; d++){
+      os << (d?",":"") << distanceNames[d] << ":" << cluster.migrationsAt[d];
     }
-    // Output events for clock cycle
-    os << time << "\t" << event << endl;
-    // New clock cycle
-    time++;
   }
-  os << "******************** End simulation ************************" << endl;
-  printResults(completed, os);
+  if(cluster.remoteStretch != numaUnit){
+    os << " numa=" << round(1000.0 * cluster.remoteStretch / numaUnit) / 1000 << " balance=" << balanceNames[cluster.numaAware]
+       << " numa_cycles=" << cluster.numaCycles << " throughput=" << 1000.0 * summary.processes / max(1, cluster.time);
+  }
+  os << endl;
 }
 
-void schedulePriority(priority_queue<Process> processes, ostream& os){
-  /* cast to int */
-  int processCount = (int)processes.size();
-  os << "Running the Priority scheduler..." << endl;
-  ProcessQueue waiting;
-  vector<Process> completed;
-  vector<Process> cpu;
-  int time = 0;
-  os << "Time\tEvent" << endl;
-  while(completed.size() != processCount){
-    string event = "";
-    // Waiting processes wait value incremented
-    waiting.incrementWaits(waiting);
-    // Processes arrive
-    /* added empty check */
-    while(!processes.empty() && processes.top().arrival == time){
-      event = event + "P" + to_string(processes.top().pid) + " arrives; ";
-      waiting.push(processes.top());
-      processes.pop();
+void runBatch(istream& is, ostream& os){
+  string text;
+  int line = 0;
+  while(getline(is, text)){
+    line++;
+    vector<string> tokens = getTokens(text);
+    if(tokens.empty() || tokens[0][0] == '#'){
+      continue;
     }
-    // Sort waiting list by priority
-    waiting.sortByPriority(waiting);
-    if(cpu.empty()){
-      // New process put on cpu
-      if(!waiting.empty()){
-        event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-        cpu.push_back(waiting.front());
-        waiting.pop();
-      }
-    }else{
-      /* cast to int */
-      for(int i=0; i < (int)cpu.size(); i++){
-        // Cpu processes are incremented
-        cpu[i].completedCycles++;
-        if(cpu[i].completedCycles == cpu[i].burst){
-          event = event + "P" + to_string(cpu[i].pid) + " completed; ";
-          completed.push_back(cpu[i]);
-          cpu.erase(cpu.begin()+i);
-          // New process put on cpu
-          if(!waiting.empty()){
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            cpu.push_back(waiting.front());
-            waiting.pop();
-          }
-        }
+    if(tokens[0] == "quit"){
+      break;
+    }
+    string id = to_string(line);
+    int timeQuantum = 0;
+    bool autoQuantum = false;
+    int objective = TUNE_MEAN_WAIT;
+    double penalty = 0;
+    bool aging = false;
+    int nodeCount = 1;
+    int placement = PLACE_SHORTEST_QUEUE;
+    int migrationCost = -1;
+    unsigned seed = 1;
+    int window = 0;
+    int threads = max(1, (int)thread::hardware_concurrency());
+    int tickMicros = 1000;
+    string tracePath;
+    string sinkName;
+    string estimate = "off";
+    int replications = 0;
+    double precision = 0.05;
+    int other = 0;
+    Topology topology;
+    bool badTopology = false;
+    int affinity = AFFINITY_NONE;
+    bool affinityGiven = false;
+    double numaFactor = 1;
+    string balance = "naive";
+    bool numaGiven = false;
+    int governor = -1;
+    string governorName;
+    vector<FrequencyState> states = defaultStates();
+    bool badStates = false;
+    double idlePower = 50;
+    double cap = numeric_limits<double>::infinity();
+    bool powerGiven = false;
+    for(int i=2; i < (int)tokens.size(); i++){
+      if(tokens[i].compare(0, 3, "id=") == 0){
+        id = tokens[i].substr(3);
+      }else if(tokens[i] == "quantum=auto"){
+        autoQuantum = true;
+      }else if(tokens[i].compare(0, 8, "quantum=") == 0){
+        timeQuantum = atoi(tokens[i].c_str() + 8);
+      }else if(tokens[i] == "objective=p99"){
+        objective = TUNE_P99_TURNAROUND;
+      }else if(tokens[i] == "objective=mixed"){
+        objective = TUNE_MIXED;
+      }else if(tokens[i].compare(0, 8, "penalty=") == 0){
+        penalty = atof(tokens[i].c_str() + 8);
+      }else if(tokens[i] == "aging=on"){
+        aging = true;
+      }else if(tokens[i].compare(0, 6, "nodes=") == 0){
+        nodeCount = atoi(tokens[i].c_str() + 6);
+      }else if(tokens[i].compare(0, 10, "placement=") == 0){
+        placement = parsePlacement(tokens[i].substr(10));
+      }else if(tokens[i].compare(0, 8, "migrate=") == 0){
+        migrationCost = tokens[i] == "migrate=off"?-1:atoi(tokens[i].c_str() + 8);
+      }else if(tokens[i].compare(0, 5, "seed=") == 0){
+        seed = strtoul(tokens[i].c_str() + 5, NULL, 10);
+      }else if(tokens[i].compare(0, 7, "window=") == 0){
+        window = atoi(tokens[i].c_str() + 7);
+      }else if(tokens[i].compare(0, 8, "threads=") == 0){
+        threads = atoi(tokens[i].c_str() + 8);
+      }else if(tokens[i].compare(0, 5, "tick=") == 0){
+        tickMicros = atoi(tokens[i].c_str() + 5);
+      }else if(tokens[i].compare(0, 6, "trace=") == 0){
+        tracePath = tokens[i].substr(6);
+      }else if(tokens[i].compare(0, 5, "sink=") == 0){
+        sinkName = tokens[i].substr(5);
+      }else if(tokens[i].compare(0, 9, "estimate=") == 0){
+        estimate = tokens[i].substr(9);
+      }else if(tokens[i].compare(0, 10, "replicate=") == 0){
+        replications = atoi(tokens[i].c_str() + 10);
+      }else if(tokens[i].compare(0, 10, "precision=") == 0){
+        precision = atof(tokens[i].c_str() + 10);
+      }else if(tokens[i].compare(0, 8, "compare=") == 0){
+        other = parsePolicy(tokens[i].substr(8));
+        other = other?other:-1;
+      }else if(tokens[i].compare(0, 9, "topology=") == 0){
+        badTopology = badTopology || !parseTopology(tokens[i].substr(9), topology);
+      }else if(tokens[i].compare(0, 9, "distance=") == 0){
+        badTopology = badTopology || !parseDistanceCosts(tokens[i].substr(9), topology);
+      }else if(tokens[i].compare(0, 9, "affinity=") == 0){
+        affinity = parseAffinity(tokens[i].substr(9));
+        affinityGiven = true;
+      }else if(tokens[i].compare(0, 5, "numa=") == 0){
+        numaFactor = atof(tokens[i].c_str() + 5);
+        numaGiven = true;
+      }else if(tokens[i].compare(0, 8, "balance=") == 0){
+        balance = tokens[i].substr(8);
+        numaGiven = true;
+      }else if(tokens[i].compare(0, 9, "governor=") == 0){
+        governorName = tokens[i].substr(9);
+        governor = parseGovernor(governorName);
+      }else if(tokens[i].compare(0, 7, "states=") == 0){
+        badStates = !parseStates(tokens[i].substr(7), states);
+        powerGiven = true;
+      }else if(tokens[i].compare(0, 5, "idle=") == 0){
+        idlePower = atof(tokens[i].c_str() + 5);
+        powerGiven = true;
+      }else if(tokens[i].compare(0, 4, "cap=") == 0){
+        cap = atof(tokens[i].c_str() + 4);
+        powerGiven = true;
       }
     }
-    // Output events for clock cycle
-    os << time << "\t" << event << endl;
-    // New clock cycle
-    time++;
-  }
-  os << "******************** End simulation ************************" << endl;
-  printResults(completed, os);
-}
-
-void schedulePreemptivePriority(priority_queue<Process> processes, ostream& os){
-  /* cast to int */
-  int processCount = (int)processes.size();
-  os << "Running the Preemptive Priority scheduler..." << endl;
-  ProcessQueue waiting;
-  vector<Process> completed;
-  vector<Process> cpu;
-  int time = 0;
-  os << "Time\tEvent" << endl;
-  while(completed.size() != processCount){
-    string event = "";
-    // Waiting processes wait value incremented
-    waiting.incrementWaits(waiting);
-    // Processes arrive
-    /* added empty check */
-    while(!processes.empty() && processes.top().arrival == time){
-      event = event + "P" + to_string(processes.top().pid) + " arrives; ";
-      waiting.push(processes.top());
-      processes.pop();
+    int policy = parsePolicy(tokens[0]);
+    if(topology.described && nodeCount == 1){
+      nodeCount = topology.coreCount();
     }
-    // Sort waiting list by priority
-    waiting.sortByPriority(waiting);
-    if(cpu.empty()){
-      // New process put on cpu
-      if(!waiting.empty()){
-        event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-        cpu.push_back(waiting.front());
-        waiting.pop();
-      }
-    }else{
-      /* cast to int */
-      for(int i=0; i < (int)cpu.size(); i++){
-        // Cpu processes are incremented
-        cpu[i].completedCycles++;
-        if(cpu[i].completedCycles == cpu[i].burst){
-          event = event + "P" + to_string(cpu[i].pid) + " completed; ";
-          completed.push_back(cpu[i]);
-          cpu.erase(cpu.begin()+i);
-          // New process put on cpu
-          if(!waiting.empty()){
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            cpu.push_back(waiting.front());
-            waiting.pop();
-          }
-        }else if(!waiting.empty()){
-          if(cpu[i].priorityWithWindchill() > waiting.front().priorityWithWindchill()){
-            event = event + "P" + to_string(cpu[i].pid) + " taken off CPU; ";
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            waiting.push(cpu[i]);
-            cpu.erase(cpu.begin()+i);
-            cpu.push_back(waiting.front());
-            waiting.pop();
-            waiting.sortByPriority(waiting);
-          }
-        }
+    bool classed = tokens.size() > 1 && tokens[1].compare(0, 8, "classes:") == 0;
+    bool streamed = classed || (tokens.size() > 1 && tokens[1].compare(0, 7, "stream:") == 0);
+    vector<Process> inlineArrivals;
+    const vector<Process>* arrivals = tokens.size() > 1 && !streamed?jobWorkload(tokens[1], tickMicros, inlineArrivals):NULL;
+    ifstream streamFile;
+    if(streamed){
+      streamFile.open(tokens[1].substr(classed?8:7).c_str());
+    }
+    vector<ProcessClass> classes;
+    if(classed){
+      loadClasses(streamFile, classes);
+    }
+    const Process* bad = arrivals != NULL?unrunnable(*arrivals):NULL;
+    Process badMember;
+    for(int c=0; c < (int)classes.size() && bad == NULL; c++){
+      if(classes[c].burst < 1 || classes[c].arrival < 0){
+        badMember = Process(classes[c].pid, (int)classes[c].arrival, classes[c].burst, classes[c].priority);
+        bad = &badMember;
       }
     }
-    // Output events for clock cycle
-    os << time << "\t" << event << endl;
-    // New clock cycle
-    time++;
-  }
-  os << "******************** End simulation ************************" << endl;
-  printResults(completed, os);
-}
-
-void scheduleRR(priority_queue<Process> processes, ostream& os){
-  /* cast to int */
-  int processCount = (int)processes.size();
-  int timeQuantum;
-  int contiguousCycles = 0;
-  cout << "Time quantum: ";
-  cin >> timeQuantum;
-  os << "Running the RR scheduler..." << endl;
-  ProcessQueue waiting;
-  vector<Process> completed;
-  vector<Process> cpu;
-  int time = 0;
-  os << "Time\tEvent" << endl;
-  while(completed.size() != processCount){
-    string event = "";
-    // Waiting processes wait values incremented
-    waiting.incrementWaits(waiting);
-    // Processes arrive
-    /* added empty check */
-    while(!processes.empty() && processes.top().arrival == time){
-      event = event + "P" + to_string(processes.top().pid) + " arrives; ";
-      waiting.push(processes.top());
-      processes.pop();
+    StreamArrivals lines(streamFile);
+    ClassArrivals members(classes);
+    ArrivalSource* source = classed?(ArrivalSource*)&members:&lines;
+    DiscardSink discard;
+    StatsSink* stats = sinkName == "stats"?new StatsSink:NULL;
+    ofstream sinkFile;
+    FileSink fileSink(sinkFile);
+    CompletionSink* sink = NULL;
+    if(sinkName == "discard"){
+      sink = &discard;
+    }else if(stats != NULL){
+      sink = stats;
+    }else if(sinkName.compare(0, 5, "file:") == 0){
+      sinkFile.open(sinkName.substr(5).c_str(), ios::trunc);
+      sink = &fileSink;
     }
-    if(cpu.empty()){
-      // New process put on cpu
-      if(!waiting.empty()){
-        event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-        cpu.push_back(waiting.front());
-        waiting.pop();
-        contiguousCycles++;
+    TraceEvents* trace = tracePath.empty()?NULL:new TraceEvents(tracePath, id);
+    vector<TraceTrack> tracks;
+    if(!sinkName.empty() && sink == NULL){
+      os << "error id=" << id << " unknown sink " << sinkName << endl;
+    }else if(sink == &fileSink && !sinkFile){
+      os << "error id=" << id << " cannot write completions " << sinkName.substr(5) << endl;
+    }else if(trace != NULL && !trace->ok()){
+      os << "error id=" << id << " cannot write trace " << tracePath << endl;
+    }else if(policy == 0){
+      os << "error id=" << id << " unknown algorithm " << tokens[0] << endl;
+    }else if(streamed?!streamFile.is_open():arrivals == NULL){
+      os << "error id=" << id << " cannot read workload " << (tokens.size() > 1?tokens[1]:"") << endl;
+    }else if(bad != NULL){
+      os << "error id=" << id << " P" << bad->pid << " needs a burst of at least 1 and an arrival of at least 0" << endl;
+    }else if(policy == POLICY_RR && timeQuantum < 1 && !autoQuantum){
+      os << "error id=" << id << " rr needs quantum=N" << endl;
+    }else if(nodeCount < 1 || placement == 0){
+      os << "error id=" << id << " bad nodes or placement" << endl;
+    }else if(badTopology || affinity < 0 || (topology.described && nodeCount != topology.coreCount())){
+      os << "error id=" << id << " bad topology, distance or affinity" << endl;
+    }else if(nodeCount == 1 && (topology.described || affinityGiven)){
+      os << "error id=" << id << " topology= and affinity= need a run on more than one core" << endl;
+    }else if(numaFactor < 1 || (balance != "naive" && balance != "aware")){
+      os << "error id=" << id << " numa=F needs F of 1 or more and balance=naive|aware" << endl;
+    }else if(numaGiven && !topology.described){
+      os << "error id=" << id << " numa= and balance= need a topology= of more than one core" << endl;
+    }else if(badStates || (powerGiven && governorName.empty())){
+      os << "error id=" << id << " states=, idle= and cap= need governor= and states of SPEED:POWER" << endl;
+    }else if(!governorName.empty() && (governor < 0 || streamed || sink != NULL || nodeCount > 1)){
+      os << "error id=" << id << " governor= needs a known governor and a single node run keeping its processes" << endl;
+    }else if((streamed || sink != NULL) && (nodeCount > 1 || autoQuantum)){
+      os << "error id=" << id << " stream and sink runs need nodes=1 and a fixed quantum" << endl;
+    }else if(estimate != "off" && ((estimate != "on" && estimate != "only") || streamed || sink != NULL || nodeCount > 1)){
+      os << "error id=" << id << " estimate=on|only needs a single node run keeping its processes" << endl;
+    }else if(estimate == "only"){
+      printEstimateRecord(*arrivals, policy, timeQuantum, aging, id, os);
+    }else if((replications != 0 || other != 0)
+             && (replications < 1 || other < 0 || precision < 0 || streamed || sink != NULL || nodeCount > 1 || autoQuantum
+                 || (other == POLICY_RR && timeQuantum < 1))){
+      os << "error id=" << id << " replicate=N needs a known compare=ALG and a single node run keeping its processes" << endl;
+    }else if(replications > 0){
+      Replication replication = replicate(*arrivals, policy, other, timeQuantum, aging, replications, precision, seed, max(1, threads));
+      printReplicationRecord(replication, policy, other, timeQuantum, aging, (int)arrivals->size(), id, os);
+    }else if(classed && policy == POLICY_FCFS && sink != NULL && (sink == &discard || sink == stats) && trace == NULL){
+      long long processes, segments;
+      profileReset();
+      long long cycles = runClassesFCFS(classes, stats, processes, segments);
+      printSinkRecord(policy, timeQuantum, aging, processes, cycles, segments, sinkName, stats, id, os);
+    }else if(nodeCount > 1){
+      if(policy == POLICY_RR && autoQuantum){
+        timeQuantum = tuneQuantum(*arrivals, aging, objective, penalty, NULL).quantum;
+      }
+      Process::setUseAging(aging);
+      Cluster cluster(*arrivals, nodeCount, policy, timeQuantum, placement, migrationCost, seed);
+      if(topology.described){
+        cluster.topology = topology;
+      }else{
+        copy(topology.cost, topology.cost + DISTANCES, cluster.topology.cost);
+      }
+      cluster.affinity = affinity;
+      cluster.remoteStretch = (int)(numaFactor * numaUnit + 0.5);
+      cluster.numaAware = balance == "aware";
+      if(trace != NULL){
+        traceCluster(cluster, trace, tracks);
+      }
+      if(window > 0){
+        runClusterParallel(cluster, window, threads);
+      }else{
+        runCluster(cluster);
       }
+      if(trace != NULL){
+        finishTrace(trace, tracks, cluster.time);
+        trace = NULL;
+      }
+      printClusterRecord(cluster, timeQuantum, window, id, os);
     }else{
-      /* cast to int */
-      for(int i=0; i < (int)cpu.size(); i++){
-        // Cpu processes are incremented
-        cpu[i].completedCycles++;
-        contiguousCycles++;
-        // If current process completed
-        if(cpu[i].completedCycles == cpu[i].burst){
-          event = event + "P" + to_string(cpu[i].pid) + " completed; ";
-          completed.push_back(cpu[i]);
-          cpu.erase(cpu.begin() + i);
-          // New process put on cpu
-          if(!waiting.empty()){
-            event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-            cpu.push_back(waiting.front());
-            waiting.pop();
-            contiguousCycles = 0;
-          }
-        }else if(contiguousCycles >= timeQuantum && !waiting.empty()){
-          event = event + "P" + to_string(cpu[i].pid) + " taken off CPU; ";
-          event = event + "P" + to_string(waiting.front().pid) + " put on CPU; ";
-          waiting.push(cpu[i]);
-          cpu.erase(cpu.begin()+i);
-          cpu.push_back(waiting.front());
-          waiting.pop();
-          waiting.sortByRemainingTime(waiting);
-          contiguousCycles = 0;
-        }
+      if(policy == POLICY_RR && autoQuantum){
+        timeQuantum = tuneQuantum(*arrivals, aging, objective, penalty, NULL).quantum;
+      }
+      Process::setUseAging(aging);
+      profileReset();
+      Simulation sim(streamed?vector<Process>():*arrivals, policy, timeQuantum);
+      Dvfs* dvfs = governor >= 0?new Dvfs(states, governor, idlePower, cap):NULL;
+      sim.sink = sink;
+      sim.dvfs = dvfs;
+      if(streamed){
+        sim.streamFrom(source);
       }
+      if(trace != NULL){
+        tracks.push_back(TraceTrack(trace, 0, "CPU"));
+        sim.track = &tracks[0];
+      }
+      while(!sim.done()){
+        sim.step(NULL);
+      }
+      if(trace != NULL){
+        finishTrace(trace, tracks, sim.time);
+        trace = NULL;
+      }
+      if(lines.outOfOrder){
+        os << "error id=" << id << " " << tokens[1] << " is not in arrival order" << endl;
+      }else if(lines.badProcess){
+        os << "error id=" << id << " " << tokens[1] << " has a process with a burst below 1 or a negative arrival" << endl;
+      }else if(sink != NULL){
+        printSinkRecord(sim.policy, sim.timeQuantum, sim.useAging, sim.sunk, sim.time, -1, sinkName, stats, id, os);
+      }else{
+        printRecord(sim, id, os, estimate == "on");
+      }
+      delete dvfs;
     }
-    // Output events for the clock cycle
-    os << time << "\t" << event << endl;
-    // New clock cycle
-    time++;
+    delete trace;
+    delete stats;
   }
-  os << "******************** End simulation ************************" << endl;
-  printResults(completed, os);
 }
 
-int main(){
+int main(int argc, char* argv[]){
   /* rearanged things a bit, added looped menu and file change and exit options */
+  if(argc > 1 && string(argv[1]) == "--batch"){
+    runBatch(cin, cout);
+    return 0;
+  }
+  // --import [US] turns a scheduler trace on stdin into a workload on stdout
+  if(argc > 1 && string(argv[1]) == "--import"){
+    int tickMicros = argc > 2?atoi(argv[2]):1000;
+    if(tickMicros < 1){
+      cerr << "The tick must be at least 1 microsecond" << endl;
+      return 1;
+    }
+    // Kept apart from stdio, cin reads a capture about three times faster
+    ios::sync_with_stdio(false);
+    TraceImport import(tickMicros, &cout, NULL);
+    import.read(cin);
+    printImportSummary(import, cerr);
+    return 0;
+  }
   priority_queue<Process> processes;
   int schedulingType;
   int menuOption = 0;
@@ -469,16 +594,16 @@ int main(){
   ofstream outFile;
   cout << "Enter the name of the input file.  : ";
   cin >> inputFile;
-  string text;
   string ageString = "on";
   ostream* outChoice;
+  WhatIfBaseline baseline;
+  int baselinePolicy = 0;
+  int baselineQuantum = 0;
+  bool baselineAging = false;
   outChoice = &cout;
   Process::setUseAging(false);
   inFile.open(inputFile.c_str());
-  while(getline(inFile,text)){
-    vector<string> tokens = getTokens(text);
-    processes.push(Process(atoi(tokens[0].c_str()),atoi(tokens[1].c_str()),atoi(tokens[2].c_str()),atoi(tokens[3].c_str())));
-  }
+  loadWorkload(inFile, processes);
   inFile.close();
   while(menuOption != 10){
     cout << "Choose your scheduling algorithm:" << endl;
@@ -493,6 +618,17 @@ int main(){
     cout << "9) output to file" << endl;
     cout << "0) Turn aging " << ageString << endl;
     cout << "10) exit program" << endl;
+    cout << "11) checkpoint every N cycles (now " << checkpointInterval << ", 0 is off)" << endl;
+    cout << "12) resume from checkpoint" << endl;
+    cout << "13) what-if: change one process and rerun" << endl;
+    cout << "14) RR with an auto-tuned quantum" << endl;
+    cout << "15) cluster: spread the processes over several nodes" << endl;
+    cout << "16) import a perf sched or ftrace capture as the input file" << endl;
+    cout << "17) estimate every algorithm from queueing models" << endl;
+    cout << "18) replicate: confidence intervals over workloads drawn like this one" << endl;
+    cout << "19) SMP: cores with shared caches and processor affinity" << endl;
+    cout << "20) NUMA: compare aware and naive balancing across sockets" << endl;
+    cout << "21) DVFS: energy and latency of every algorithm under each governor" << endl;
     cout << "-> ";
     cin >> menuOption;
     if(menuOption == 0){
@@ -506,15 +642,211 @@ int main(){
       outChoice = &cout;
     }else if(menuOption == 9){
       outChoice = &outFile;
+    }else if(menuOption == 11){
+      cout << "Checkpoint every how many cycles? ";
+      cin >> checkpointInterval;
+      if(checkpointInterval > 0){
+        cout << "Enter the name of the checkpoint file. ";
+        cin >> checkpointFile;
+      }
+    }else if(menuOption == 12){
+      Simulation sim;
+      cout << "Enter the name of the checkpoint file. ";
+      cin >> checkpointFile;
+      if(sim.load(checkpointFile)){
+        runSimulation(sim, *outChoice);
+      }else{
+        cout << "Could not read checkpoint " << checkpointFile << endl;
+      }
+      outFile.close();
+    }else if(menuOption == 14){
+      int objective;
+      double penalty = 0;
+      cout << "Tune for 1) mean wait 2) p99 turnaround 3) mean wait with switch penalty: ";
+      cin >> objective;
+      if(objective == TUNE_MIXED){
+        cout << "Penalty per context switch (cycles): ";
+        cin >> penalty;
+      }
+      if(objective >= TUNE_MEAN_WAIT && objective <= TUNE_MIXED){
+        TuneCandidate best = tuneQuantum(arrivalOrder(processes), Process::UseAging(), objective, penalty, outChoice);
+        scheduleRR(processes, *outChoice, best.quantum);
+      }
+      outFile.close();
+    }else if(menuOption == 15){
+      int nodeCount, placement, policy, timeQuantum = 0, migrationCost, window;
+      cout << "Number of nodes: ";
+      cin >> nodeCount;
+      cout << "Placement 1) random 2) join shortest queue 3) power of two choices 4) least loaded: ";
+      cin >> placement;
+      cout << "Scheduling algorithm on each node (1-5): ";
+      cin >> policy;
+      if(policy == POLICY_RR){
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+      }
+      cout << "Migration cost in cycles (-1 for no migration): ";
+      cin >> migrationCost;
+      cout << "Parallel window in cycles (0 runs on one thread): ";
+      cin >> window;
+      if(nodeCount > 0 && placement >= PLACE_RANDOM && placement <= PLACE_LEAST_LOADED
+         && policy >= POLICY_FCFS && policy <= POLICY_RR && (policy != POLICY_RR || timeQuantum > 0)){
+        Cluster cluster(arrivalOrder(processes), nodeCount, policy, timeQuantum, placement, migrationCost, 1);
+        TraceEvents* trace = openTraceEvents("cluster");
+        vector<TraceTrack> tracks;
+        if(trace != NULL){
+          traceCluster(cluster, trace, tracks);
+        }
+        if(window > 0){
+          runClusterParallel(cluster, window, thread::hardware_concurrency());
+        }else{
+          runCluster(cluster);
+        }
+        if(trace != NULL){
+          finishTrace(trace, tracks, cluster.time);
+        }
+        printClusterResults(cluster, *outChoice);
+      }
+      outFile.close();
+    }else if(menuOption == 13){
+      int policy, timeQuantum = 0;
+      Process changed;
+      cout << "Scheduling algorithm (1-5): ";
+      cin >> policy;
+      if(policy == POLICY_RR){
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+      }
+      cout << "PID, new arrival, burst and priority: ";
+      cin >> changed.pid >> changed.arrival >> changed.burst >> changed.priority;
+      // The baseline is recorded once and kept while the question stays the same
+      if(baselinePolicy != policy || baselineQuantum != timeQuantum || baselineAging != Process::UseAging()){
+        baseline = recordBaseline(processes, policy, timeQuantum, whatIfInterval);
+        baselinePolicy = policy;
+        baselineQuantum = timeQuantum;
+        baselineAging = Process::UseAging();
+      }
+      WhatIfResult answer = whatIf(baseline, changed, *outChoice);
+      printResults(answer.completed(), *outChoice, "what-if");
+      *outChoice << "Baseline Average Wait Time: " << averageWait(baseline.finished.completed) << endl;
+      outFile.close();
+    }else if(menuOption == 16){
+      string traceName, workloadName;
+      int tickMicros;
+      cout << "Enter the name of the trace file. ";
+      cin >> traceName;
+      cout << "Microseconds per cycle: ";
+      cin >> tickMicros;
+      cout << "Enter the name of the workload file to write. ";
+      cin >> workloadName;
+      ifstream traceFile(traceName.c_str());
+      ofstream workloadFile(workloadName.c_str());
+      if(!traceFile || !workloadFile || tickMicros < 1){
+        cout << "Could not import " << traceName << endl;
+      }else{
+        processes = priority_queue<Process>();
+        TraceImport import(tickMicros, &workloadFile, &processes);
+        import.read(traceFile);
+        printImportSummary(import, cout);
+        inputFile = workloadName;
+        baselinePolicy = 0;
+      }
+    }else if(menuOption == 17){
+      printEstimates(arrivalOrder(processes), *outChoice);
+      outFile.close();
+    }else if(menuOption == 18){
+      int policy, other, timeQuantum = 0, most;
+      double precision;
+      cout << "Scheduling algorithm (1-5): ";
+      cin >> policy;
+      cout << "Algorithm to compare with on the same workloads (1-5, 0 for none): ";
+      cin >> other;
+      if(policy == POLICY_RR || other == POLICY_RR){
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+      }
+      cout << "Most replications: ";
+      cin >> most;
+      cout << "Precision, as a fraction of each mean (0.05 is 5%): ";
+      cin >> precision;
+      if(policy >= POLICY_FCFS && policy <= POLICY_RR && other >= 0 && other <= POLICY_RR && most > 0
+         && (timeQuantum > 0 || (policy != POLICY_RR && other != POLICY_RR))){
+        Replication replication = replicate(arrivalOrder(processes), policy, other, timeQuantum, Process::UseAging(),
+                                            most, precision, 1, max(1, (int)thread::hardware_concurrency()));
+        printReplication(replication, other, *outChoice);
+      }
+      outFile.close();
+    }else if(menuOption == 19){
+      Topology topology;
+      string shape, costs;
+      int policy, timeQuantum = 0, migrationCost, affinity;
+      cout << "Topology as SxLxMxC (sockets x LLC groups x L2 groups x cores): ";
+      cin >> shape;
+      cout << "Cycles to refill the cache from an L2, LLC, socket and remote core, as L2,LLC,SOCKET,REMOTE: ";
+      cin >> costs;
+      cout << "Affinity 0) none 1) soft 2) hard 3) wake-affine: ";
+      cin >> affinity;
+      cout << "Scheduling algorithm on each core (1-5): ";
+      cin >> policy;
+      if(policy == POLICY_RR){
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+      }
+      cout << "Migration cost in cycles (-1 for no migration): ";
+      cin >> migrationCost;
+      if(parseTopology(shape, topology) && parseDistanceCosts(costs, topology) && affinity >= AFFINITY_NONE
+         && affinity <= AFFINITY_WAKE && policy >= POLICY_FCFS && policy <= POLICY_RR && (policy != POLICY_RR || timeQuantum > 0)){
+        Cluster cluster(arrivalOrder(processes), topology.coreCount(), policy, timeQuantum, PLACE_SHORTEST_QUEUE, migrationCost, 1);
+        cluster.topology = topology;
+        cluster.affinity = affinity;
+        runCluster(cluster);
+        printClusterResults(cluster, *outChoice);
+      }else{
+        cout << "Could not use topology " << shape << " with costs " << costs << endl;
+      }
+      outFile.close();
+    }else if(menuOption == 20){
+      Topology topology;
+      string shape;
+      double factor;
+      int policy, timeQuantum = 0, migrationCost;
+      cout << "Topology as SxLxMxC (sockets x LLC groups x L2 groups x cores): ";
+      cin >> shape;
+      cout << "Slowdown of a fully memory bound burst away from its home socket (1.5 is 50%): ";
+      cin >> factor;
+      cout << "Scheduling algorithm on each core (1-5): ";
+      cin >> policy;
+      if(policy == POLICY_RR){
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+      }
+      cout << "Migration cost in cycles (-1 for no migration): ";
+      cin >> migrationCost;
+      if(parseTopology(shape, topology) && factor >= 1 && policy >= POLICY_FCFS && policy <= POLICY_RR
+         && (policy != POLICY_RR || timeQuantum > 0)){
+        printNumaComparison(arrivalOrder(processes), topology, factor, policy, timeQuantum, migrationCost, *outChoice);
+      }else{
+        cout << "Could not use topology " << shape << endl;
+      }
+      outFile.close();
+    }else if(menuOption == 21){
+      int timeQuantum;
+      double cap;
+      cout << "Time quantum for RR: ";
+      cin >> timeQuantum;
+      cout << "Power cap (0 for none, full speed draws 1000): ";
+      cin >> cap;
+      if(timeQuantum > 0){
+        printDvfsComparison(arrivalOrder(processes), defaultStates(), 50, cap > 0?cap:numeric_limits<double>::infinity(),
+                            timeQuantum, *outChoice);
+      }
+      outFile.close();
     }else if(menuOption == 6){
+      baselinePolicy = 0;
       cout << "Enter the name of the input file.  : ";
       cin >> inputFile;
       inFile.open(inputFile.c_str());
-      string text;
-      while(getline(inFile,text)){
-        vector<string> tokens = getTokens(text);
-        processes.push(Process(atoi(tokens[0].c_str()),atoi(tokens[1].c_str()),atoi(tokens[2].c_str()),atoi(tokens[3].c_str())));
-      }
+      loadWorkload(inFile, processes);
       inFile.close();
     }else if(menuOption < 6){
       schedulingType = menuOption;
@@ -527,9 +859,13 @@ int main(){
       }else if(schedulingType == 4){
         schedulePreemptivePriority(processes, *outChoice);
       }else if(schedulingType == 5){
-        scheduleRR(processes, *outChoice);
+        int timeQuantum;
+        cout << "Time quantum: ";
+        cin >> timeQuantum;
+        scheduleRR(processes, *outChoice, timeQuantum);
       }
       outFile.close();
     }
   }
-};
+  return 0;
+}
@@ -1,5 +1,7 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include "gantt.h"
+#include "report.h"
 
 int menu(){
     int esc;
@@ -30,7 +32,7 @@ int painel(){
     printf("\n\n    Your choice: ");
     scanf("%i", &esc);
     if (esc>2)
-        painel();
+        return painel();
     else
         return esc;
 }
@@ -47,348 +49,394 @@ struct processes{
     int prio;
     int execu;
     int esp;
+    int arr;
+    int resp;
+    int fim;
     struct processes *prox;
     /*
         id - process identification
         dur - process duration
         exe - process execution time
         esp - process wait time
+        arr - process arrival time
+        resp - time from arrival to the first slice, -1 until it runs
+        fim - time the process finishes
     */
 };
 
-struct processes *enter_processes(int id, int dur, int prio){
+#define SLAB_FIRST_NODES 64
+
+struct process_slab{
+    struct process_slab *next;
+    int cap;
+    int used;
+    struct processes *nodes;
+    /*
+        next - next (bigger) slab of the arena
+        cap - number of nodes the slab holds
+        used - nodes already handed out since the last reset
+        nodes - the node storage, placed right after the slab header
+    */
+};
+
+struct process_arena{
+    struct process_slab *first;
+    struct process_slab *current;
+    /*
+        first - first slab, where a reset starts handing out nodes again
+        current - slab the next node is taken from
+    */
+};
+
+void arena_reset(struct process_arena *arena){
+    /*slabs are kept, the nodes are handed out again from the first one*/
+    arena->current = arena->first;
+    if(arena->current != NULL)
+        arena->current->used = 0;
+}
+
+void arena_release(struct process_arena *arena){
+    struct process_slab *slab = arena->first, *next;
+    while(slab != NULL){
+        next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    arena->first = arena->current = NULL;
+}
+
+struct processes *arena_node(struct process_arena *arena){
+    struct process_slab *slab = arena->current;
+    int cap;
+    if(slab != NULL && slab->used < slab->cap)
+        return &slab->nodes[slab->used++];
+    if(slab != NULL && slab->next != NULL){/*reuse a slab kept from an earlier run*/
+        slab = slab->next;
+        slab->used = 0;
+    }
+    else{/*grow geometrically so big lists need few slabs*/
+        cap = slab == NULL ? SLAB_FIRST_NODES : slab->cap * 2;
+        slab = (struct process_slab*)malloc(sizeof(struct process_slab) + cap * sizeof(struct processes));
+        if(slab == NULL){
+            printf("Allocation error. \n End of execution\n");
+            exit(1);
+        };
+        slab->next = NULL;
+        slab->cap = cap;
+        slab->used = 0;
+        slab->nodes = (struct processes*)(slab + 1);
+        if(arena->current == NULL)
+            arena->first = slab;
+        else
+            arena->current->next = slab;
+    }
+    arena->current = slab;
+    return &slab->nodes[slab->used++];
+}
+
+struct processes *enter_processes(struct process_arena *arena, int id, int dur, int prio, int arr){
     struct processes *loc;
-    loc = (struct processes*)malloc(sizeof(struct processes));
-    if(loc == NULL){
-        printf("Allocation error. \n End of execution\n");
-        exit(1);
-    };
+    loc = arena_node(arena);
     loc->id = id;
     loc->dur = dur;
     loc->prio = prio;
     loc->execu = 0;
     loc->esp = 0;
+    loc->arr = arr;
+    loc->resp = -1;
+    loc->fim = 0;
     loc->prox = NULL;
+    return loc;
+}
+
+struct processes *copy_processes(struct process_arena *arena, struct processes *loc){
+    struct processes *copies = NULL, *tmp = NULL, *src_tmp = loc;
+    arena_reset(arena);/*the copies of the previous run are dropped in one go*/
+    while (src_tmp != NULL){/*making copies of the processes, side by side in the arena*/
+        if(copies == NULL){
+            copies = enter_processes(arena, src_tmp->id, src_tmp->dur, src_tmp->prio, src_tmp->arr);
+            tmp = copies;
+        }
+        else{
+            tmp->prox = enter_processes(arena, src_tmp->id, src_tmp->dur, src_tmp->prio, src_tmp->arr);
+            tmp = tmp->prox;
+        }
+        src_tmp = src_tmp->prox;
+    }
+    return copies;
 }
 
 void list_processes(struct processes *loc){
     struct processes *tmp = loc;
     printf("\n\n\t\t\tList of processes\n\n");
     while(tmp != NULL){
-        printf("\tProcess: %d\tPriority: %d\tDuration: %d\n", tmp->id, tmp->prio, tmp->dur);
+        printf("\tProcess: %d\tPriority: %d\tDuration: %d\tArrival: %d\n", tmp->id, tmp->prio, tmp->dur, tmp->arr);
         tmp = tmp->prox;
     }
     printf("\n");
 }
 
-void fcfs(struct processes *loc, int n_proc) {
-    int tempo = 0, starting, fim, tmp_esp=0, turnaround_time=0;
-    int p[n_proc], i=0;
-    struct processes *tmp = loc;
-    printf("\n\t\t First-Come, First-Serve (FCFS)\n\n");
-    while (tmp != NULL){
-        starting = tempo;
-        tempo += tmp->dur;
-        p[i] = tempo;
-        fim = tempo;
-        printf("\tProcess: %d\t Duration: %d\t Waiting Time: %d\tProgram finishes: %d\n", tmp->id, tmp->dur, starting, fim);
-        tmp_esp += starting;
-        tmp = tmp->prox;
-        i++;
-    }
-    i=0;
-    printf("\n\t\tAverage Waiting Time= %f\n\n\n",tmp_esp*1.0/n_proc);
-    printf("\t    Gantt chart.");
-    printf("\n\n\t\t    ");
-    for (i=0; i<n_proc; i++){
-            printf("| P%d ", i+1);
+struct slice{
+    int id;
+    int arr;
+    int start;
+    int end;
+    /*
+        id - process running in the slice
+        arr - time the process arrived
+        start - time the slice starts
+        end - time the slice ends
+    */
+};
+
+struct schedule{
+    struct slice *slices;
+    int n;
+    int cap;
+    /*
+        slices - slices in execution order
+        n - slices recorded by the last run
+        cap - slices the array holds before it has to grow
+    */
+};
+
+void schedule_add(struct schedule *sched, int id, int arr, int start, int end){
+    struct slice *grown;
+    if(sched->n == sched->cap){/*the array is kept between runs, so it rarely grows*/
+        sched->cap = sched->cap == 0 ? 16 : sched->cap * 2;
+        grown = (struct slice*)realloc(sched->slices, sched->cap * sizeof(struct slice));
+        if(grown == NULL){
+            printf("Allocation error. \n End of execution\n");
+            exit(1);
+        };
+        sched->slices = grown;
     }
-    printf("|");
-    printf("\n\t\t    0  ");
-    for (i=0; i<n_proc; i++)
-        printf("  %d ", p[i]);
+    sched->slices[sched->n].id = id;
+    sched->slices[sched->n].arr = arr;
+    sched->slices[sched->n].start = start;
+    sched->slices[sched->n].end = end;
+    sched->n++;
 }
 
-void sjf(struct processes *loc, int n_proc){
-    int tempo_exe, shortest, starting, fim, tmp_esp, durc;
-    struct processes *copies, *src_tmp, *tmp, *before_shortest;
-    printf("\n\t\tShortest-Job-First- (SRTF)\n\n ");
-    src_tmp = loc;
-    copies = tmp = NULL;
-    while (src_tmp != NULL){
-        if(copies == NULL){
-            copies = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = copies;
-        }
-        else{
-            tmp->prox = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = tmp->prox;
-        }
-        src_tmp = src_tmp->prox;
-    }
-    tempo_exe = 0;
-    while(copies != NULL){/*search for the new process*/
-        before_shortest = NULL;
-        shortest = copies->dur;
-        tmp = copies->prox;
-        src_tmp = copies;
-        while(tmp != NULL){
-            if(tmp->dur < shortest){
-                shortest = tmp->dur;
-                before_shortest = src_tmp;
-            }
-            src_tmp = tmp;
-            tmp = tmp->prox;
-        }
-        if(before_shortest == NULL){/*process is executed and copies and eliminated and allocates the 1st process*/
-            starting = tempo_exe;
-            tempo_exe += copies->dur;
-            durc = copies->dur;
-            fim = tempo_exe;
-            printf("\tProcess: %d\t Duration: %d\t Waiting: %d\tProgram finishes: %d\n", copies->id, durc, starting, fim);
-            tmp_esp += fim;
-            src_tmp = copies;
-            copies = copies->prox;
-            free(src_tmp);
-        }
-        else{ /*allocates the 1st process if there is no smaller one*/
-            tmp = before_shortest->prox;
-            starting = tempo_exe;
-            tempo_exe += tmp->dur;
-            durc = tmp->dur;
-            fim = tempo_exe;
-            printf("\tProcess: %d\t Duration: %d\t Waiting: %d\tProgram finishes: %d\n", tmp->id, durc, starting, fim);
-            before_shortest->prox = tmp->prox;
-            free(tmp);
-        }
+static const struct report_column schedule_columns[] = {
+    {"process", "\tProcess: ", 0}, {"arrival", "\t Arrival: ", 0}, {"duration", "\t Duration: ", 0},
+    {"waiting", "\t Waiting: ", 0}, {"finish", "\tProgram finishes: ", 0}
+};
+
+static const struct report_column round_robin_columns[] = {
+    {"process", "\tProcess: ", 0}, {"arrival", "\t Arrival: ", 0}, {"waiting", "\t Waiting: ", 0},
+    {"response", "\t Response: ", 0}, {"finish", "\tProgram finishes: ", 0}
+};
+
+void print_schedule(struct schedule *sched, int n_proc){
+    int i, tmp_esp=0;
+    struct slice *s;
+    struct report out;
+    report_begin(&out, report_file_write, stdout, "schedule", schedule_columns, 5, REPORT_LABELLED);
+    for(i=0; i<sched->n; i++){/*a process runs in one slice, it waits from its arrival until the slice starts*/
+        s = &sched->slices[i];
+        report_int(&out, s->id);
+        report_int(&out, s->arr);
+        report_int(&out, s->end - s->start);
+        report_int(&out, s->start - s->arr);
+        report_int(&out, s->end);
+        tmp_esp += s->start - s->arr;
     }
-    printf("\n\t\tAverage Waiting Time= %f\n",tmp_esp*1.0/n_proc);
+    report_value_real(&out, "average_waiting", "\n\t\tAverage Waiting Time= ", tmp_esp*1.0/n_proc, 6);
+    report_end(&out);
 }
 
-void sjf_simulator(struct processes *loc, int n_proc){
-    int tempo_exe, shortest, starting, fim, durc, i=0, p[n_proc];
-    struct processes *copies, *src_tmp, *tmp, *before_shortest;
-    printf("\n\t    Gantt chart\n\n ");
-    src_tmp = loc;
-    copies = tmp = NULL;
-    while (src_tmp != NULL){/*making copies of the processes*/
-        if(copies == NULL){
-            copies = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = copies;
-        }
-        else{
-            tmp->prox = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = tmp->prox;
-        }
-        src_tmp = src_tmp->prox;
+void print_gantt(struct schedule *sched){
+    int i;
+    struct gantt chart;
+    if(report_format() != REPORT_TABLE)/*charts are for the table only*/
+        return;
+    printf("\n\t    Gantt chart\n\n");
+    gantt_begin(&chart, stdout, sched->n > 0 ? sched->slices[sched->n - 1].end : 0);
+    for (i=0; i<sched->n; i++)
+        gantt_add(&chart, sched->slices[i].id, sched->slices[i].start, sched->slices[i].end);
+    gantt_end(&chart);
+}
+
+int by_arrival(const void *a, const void *b){
+    const struct processes *p = *(struct processes * const *)a, *q = *(struct processes * const *)b;
+    if(p->arr != q->arr)
+        return p->arr < q->arr ? -1 : 1;
+    return p->id - q->id;
+}
+
+void fcfs(struct processes *loc, struct schedule *sched) {
+    int tempo = 0, n = 0, i;
+    struct processes *tmp, **order;
+    sched->n = 0;
+    for(tmp = loc; tmp != NULL; tmp = tmp->prox)
+        n++;
+    if(n == 0)
+        return;
+    order = (struct processes**)malloc(n * sizeof(struct processes*));
+    if(order == NULL){
+        printf("Allocation error. \n End of execution\n");
+        exit(1);
+    };
+    for(i = 0, tmp = loc; tmp != NULL; tmp = tmp->prox)
+        order[i++] = tmp;
+    qsort(order, n, sizeof(struct processes*), by_arrival);
+    for(i = 0; i < n; i++){
+        tmp = order[i];
+        if(tempo < tmp->arr)/*the cpu idles until the process arrives*/
+            tempo = tmp->arr;
+        schedule_add(sched, tmp->id, tmp->arr, tempo, tempo + tmp->dur);
+        tempo += tmp->dur;
     }
+    free(order);
+}
+
+void sjf(struct processes *loc, struct process_arena *work, struct schedule *sched){
+    int tempo_exe, first_arr;
+    struct processes *copies, *src_tmp, *tmp, *shortest, *before_shortest;
+    copies = copy_processes(work, loc);
+    sched->n = 0;
     tempo_exe = 0;
-    printf("\t\t  ");
-    while(copies != NULL){/*search for the new process*/
-        before_shortest = NULL;
-        shortest = copies->dur;
-        tmp = copies->prox;
-        src_tmp = copies;
-        while(tmp != NULL){
-            if(tmp->dur < shortest){
-                shortest = tmp->dur;
+    while(copies != NULL){/*search for the new process among those arrived*/
+        shortest = before_shortest = src_tmp = NULL;
+        first_arr = copies->arr;
+        for(tmp = copies; tmp != NULL; src_tmp = tmp, tmp = tmp->prox){
+            if(tmp->arr < first_arr)
+                first_arr = tmp->arr;
+            if(tmp->arr <= tempo_exe && (shortest == NULL || tmp->dur < shortest->dur)){
+                shortest = tmp;
                 before_shortest = src_tmp;
             }
-            src_tmp = tmp;
-            tmp = tmp->prox;
-        }
-        if(before_shortest == NULL){/*process runs and copies and eliminates and allocates the 1st process s is less*/
-            starting = tempo_exe;
-            tempo_exe += copies->dur;
-            durc = copies->dur;
-            fim = tempo_exe;
-            p[i]=tempo_exe;
-            printf("| P%d ", copies->id);
-            src_tmp = copies;
-            copies = copies->prox;
-            free(src_tmp);
         }
-        else{ /*allocates the 1st process if there is no smaller one*/
-            tmp = before_shortest->prox;
-            starting = tempo_exe;
-            tempo_exe += tmp->dur;
-            durc = tmp->dur;
-            p[i]=tempo_exe;
-            fim = tempo_exe;
-            printf("| P%d ", tmp->id);
-            before_shortest->prox = tmp->prox;
-            free(tmp);
+        if(shortest == NULL){/*nothing has arrived, the cpu idles until the first arrival*/
+            tempo_exe = first_arr;
+            continue;
         }
-        i++;
+        if(before_shortest == NULL)/*the 1st process is the shortest, it runs and leaves the copies*/
+            copies = shortest->prox;
+        else/*a later process is shorter, it runs and is unlinked*/
+            before_shortest->prox = shortest->prox;
+        schedule_add(sched, shortest->id, shortest->arr, tempo_exe, tempo_exe + shortest->dur);
+        tempo_exe += shortest->dur;
     }
-    printf("|");
-    printf("\n\t\t  0  ");
-    for (i=0; i<n_proc; i++)
-        printf("  %d ", p[i]);
 }
 
-void scheduling_priority(struct processes *loc, int n_proc){
-    int tempo_exe, starting, major, fim, tmp_esp, durc;
-    struct processes *copies, * src_tmp, *tmp, *major_prio;
-    printf("\n\t\tPriority scheduler \n\n");
-    src_tmp = loc;
-    copies = tmp = NULL;
-    while (src_tmp != NULL){/*making copies of the processes*/
-        if(copies == NULL){
-            copies = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = copies;
-        }
-        else{
-            tmp->prox = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = tmp->prox;
-        }
-        src_tmp = src_tmp->prox;
-    }
+void scheduling_priority(struct processes *loc, struct process_arena *work, struct schedule *sched){
+    int tempo_exe, first_arr;
+    struct processes *copies, *src_tmp, *tmp, *major, *major_prio;
+    copies = copy_processes(work, loc);
+    sched->n = 0;
     tempo_exe = 0;
-    while(copies != NULL){/*check next process*/
-        major_prio = NULL;
-        major = copies->prio;
-        tmp = copies->prox;
-        src_tmp = copies;
-        while(tmp != NULL){
-            if(tmp->prio < major){
-                major = tmp->prio;
+    while(copies != NULL){/*check next process among those arrived*/
+        major = major_prio = src_tmp = NULL;
+        first_arr = copies->arr;
+        for(tmp = copies; tmp != NULL; src_tmp = tmp, tmp = tmp->prox){
+            if(tmp->arr < first_arr)
+                first_arr = tmp->arr;
+            if(tmp->arr <= tempo_exe && (major == NULL || tmp->prio < major->prio)){
+                major = tmp;
                 major_prio = src_tmp;
             }
-            src_tmp = tmp;
-            tmp = tmp->prox;
-        }
-        if(major_prio == NULL){/*if 1st has major priority*/
-            starting = tempo_exe;
-            tempo_exe += copies->dur;
-            durc = copies->dur;
-            fim = tempo_exe;
-            printf("\tProcess: %d\t Duration: %d\t Waiting: %d\tProgram finishes: %d\n", copies->id, durc, starting, fim);
-            tmp_esp += fim;
-            src_tmp = copies->prox;
-            free(copies);
-            copies = src_tmp;
         }
-        else {/* if 1st has no major priority*/
-            tmp = major_prio->prox;
-            starting = tempo_exe;
-            tempo_exe += tmp->dur;
-            durc = tmp->dur;
-            fim = tempo_exe;
-            printf("\tProcess: %d\t Duration: %d\t Waiting: %d\tProgram finishes: %d\n", tmp->id, durc, starting, fim);
-            major_prio->prox = tmp->prox;
-            free(tmp);
+        if(major == NULL){/*nothing has arrived, the cpu idles until the first arrival*/
+            tempo_exe = first_arr;
+            continue;
         }
+        if(major_prio == NULL)/*if 1st has major priority*/
+            copies = major->prox;
+        else/* if 1st has no major priority*/
+            major_prio->prox = major->prox;
+        schedule_add(sched, major->id, major->arr, tempo_exe, tempo_exe + major->dur);
+        tempo_exe += major->dur;
     }
-    printf("\n\t\tAverage Waiting Time= %f\n",tmp_esp*1.0/n_proc);
 }
 
-void scheduling_priority_simulator(struct processes *loc, int n_proc){
-    int tempo_exe, starting, major, fim, durc, i=0, p[n_proc];
-    struct processes *copies, * src_tmp, *tmp, *major_prio;
-    printf("\n\t    Gantt chart\n\n ");
-    src_tmp = loc;
-    copies = tmp = NULL;
-    while (src_tmp != NULL){/*making copies of the processes*/
-        if(copies == NULL){
-            copies = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = copies;
-        }
-        else{
-            tmp->prox = enter_processes(src_tmp->id, src_tmp->dur, src_tmp->prio);
-            tmp = tmp->prox;
+struct processes *robbin_round(struct processes *loc, struct process_arena *work, int quantum, struct schedule *sched){
+    int n = 0, i, next = 0, head = 0, tail = 0, queued = 0, time = 0, run;
+    struct processes *copies, *tmp, *preempted = NULL, **order, **fifo;
+    copies = copy_processes(work, loc);
+    sched->n = 0;
+    for(tmp = copies; tmp != NULL; tmp = tmp->prox)
+        n++;
+    if(n == 0)
+        return copies;
+    order = (struct processes**)malloc(2 * n * sizeof(struct processes*));
+    if(order == NULL){
+        printf("Allocation error. \n End of execution\n");
+        exit(1);
+    };
+    fifo = order + n;/*a process is queued at most once, so n slots never overflow*/
+    for(i = 0, tmp = copies; tmp != NULL; tmp = tmp->prox)
+        order[i++] = tmp;
+    qsort(order, n, sizeof(struct processes*), by_arrival);/*arrivals are admitted in order from here*/
+    while(next < n || queued > 0 || preempted != NULL){
+        while(next < n && order[next]->arr <= time){/*arrivals up to now queue ahead of the preempted process*/
+            fifo[tail] = order[next++];
+            tail = (tail + 1) % n;
+            queued++;
         }
-        src_tmp = src_tmp->prox;
-    }
-    tempo_exe = 0;
-    printf("\t\t  ");
-    while(copies != NULL){/*check next process*/
-        major_prio = NULL;
-        major = copies->prio;
-        tmp = copies->prox;
-        src_tmp = copies;
-        while(tmp != NULL){
-            if(tmp->prio < major){
-                major = tmp->prio;
-                major_prio = src_tmp;
-            }
-            src_tmp = tmp;
-            tmp = tmp->prox;
+        if(preempted != NULL){
+            fifo[tail] = preempted;
+            tail = (tail + 1) % n;
+            queued++;
+            preempted = NULL;
         }
-        if(major_prio == NULL){/*if 1st has a higher priority*/
-            starting = tempo_exe;
-            tempo_exe += copies->dur;
-            p[i]=tempo_exe;
-            durc = copies->dur;
-            fim = tempo_exe;
-            printf("| P%d ", copies->id);
-            src_tmp = copies->prox;
-            free(copies);
-            copies = src_tmp;
+        if(queued == 0){/*nothing is ready, the cpu idles until the next arrival*/
+            time = order[next]->arr;
+            continue;
         }
-        else {/* if 1st has no higher priority*/
-            tmp = major_prio->prox;
-            starting = tempo_exe;
-            tempo_exe += tmp->dur;
-            p[i]=tempo_exe;
-            durc = tmp->dur;
-            fim = tempo_exe;
-            printf("| P%d ", tmp->id);
-            major_prio->prox = tmp->prox;
-            free(tmp);
+        tmp = fifo[head];
+        head = (head + 1) % n;
+        queued--;
+        if(tmp->resp < 0)
+            tmp->resp = time - tmp->arr;
+        run = tmp->dur - tmp->execu < quantum ? tmp->dur - tmp->execu : quantum;
+        schedule_add(sched, tmp->id, tmp->arr, time, time + run);
+        time += run;
+        tmp->execu += run;
+        if(tmp->execu < tmp->dur)
+            preempted = tmp;
+        else{
+            tmp->fim = time;
+            tmp->esp = time - tmp->arr - tmp->dur;
         }
-        i++;
     }
-    printf("|");
-    printf("\n\t\t  0  ");
-    for (i=0; i<n_proc; i++)
-        printf("  %d ", p[i]);
+    free(order);
+    return copies;
 }
 
-void robbin_round(struct processes *loc, int quantum, int n_proc){
-    int count, j, time, remain, flag=0;
-    int tmp_esp=0, turnaround_time=0, at[10], bt[10], rt[10];
-    remain=n_proc;
-    struct processes *copies, *src_tmp, *tmp, *slot;
-    printf("\n\t\tRound Robin (RR) - Quantum: %d\n", quantum);
-    src_tmp = loc;
-    for(count=0; count < n_proc; count++){
-            bt[count] = src_tmp->dur;
-            rt[count] = bt[count];
-            src_tmp = src_tmp->prox;
+void print_round_robin(struct processes *copies, struct schedule *sched, int quantum){
+    int n_proc = 0, tmp_esp = 0, turnaround_time = 0, response_time = 0;
+    struct processes *tmp;
+    struct report out;
+    char title[64];
+    report_begin(&out, report_file_write, stdout, "round_robin", round_robin_columns, 5, REPORT_LABELLED);
+    sprintf(title, "\n\t\tRound Robin (RR) - Quantum: %d\n", quantum);
+    report_title(&out, title);
+    for(tmp = copies; tmp != NULL; tmp = tmp->prox){
+        report_int(&out, tmp->id);
+        report_int(&out, tmp->arr);
+        report_int(&out, tmp->esp);
+        report_int(&out, tmp->resp);
+        report_int(&out, tmp->fim);
+        tmp_esp += tmp->esp;
+        turnaround_time += tmp->fim - tmp->arr;
+        response_time += tmp->resp;
+        n_proc++;
     }
-    for(time = 0, count = 0; remain !=0;){
-        at[count]=time;
-        if(rt[count] <= quantum && rt[count] > 0){
-            time+=rt[count];
-            rt[count]=0;
-            flag=1;
-        }
-        else if(rt[count]>0){
-            rt[count]-=quantum;
-            time+=quantum;
-        }
-        if(rt[count]==0 && flag==1){
-            remain--;
-            printf("\tProcess: %d\t Waiting: %d\tProgram finishes: %d\n", count+1, time-bt[count], time);
-            tmp_esp+=time-bt[count];
-            turnaround_time+=time;
-            flag=0;
-        }
-        if(count == n_proc-1)
-            count=0;
-        else if(at[count]<=time)
-            count++;
-        else
-            count=0;
+    if(n_proc > 0){
+        report_value_real(&out, "average_waiting", "\n\t      Average Waiting Time= ", tmp_esp*1.0/n_proc, 6);
+        report_value_real(&out, "average_turnaround", "\t   Average Turnaround Time = ", turnaround_time*1.0/n_proc, 6);
+        report_value_real(&out, "average_response", "\t     Average Response Time = ", response_time*1.0/n_proc, 6);
     }
-    printf("\n\t      Average Waiting Time= %f\n",tmp_esp*1.0/n_proc);
-    printf("\t   Average Turnaround Time = %f",turnaround_time*1.0/n_proc);
-    free(src_tmp);
+    report_end(&out);
+    print_gantt(sched);
 }
 
 int main(){
-    int esc, es_proc, n_proc, i, id, dur, prio, posi=0;
+    int esc, es_proc, n_proc, i, dur, prio, arr, posi=0;
+    struct process_arena list_arena = {NULL, NULL}, work_arena = {NULL, NULL};
+    struct schedule sched = {NULL, 0, 0};
     do{
     if (posi==0){
         es_proc=painel();
@@ -398,10 +446,11 @@ int main(){
     struct processes *list_proc, *tmp_proc;
     if(es_proc == 1){
         n_proc = 4;
-        list_proc = enter_processes(1, 12, 2);
-        list_proc->prox = enter_processes(2, 2, 1); tmp_proc = list_proc->prox;
-        tmp_proc->prox  = enter_processes(3,  8, 4); tmp_proc = tmp_proc->prox;
-        tmp_proc->prox  = enter_processes(4,  10, 3);
+        arena_reset(&list_arena);
+        list_proc = enter_processes(&list_arena, 1, 12, 2, 0);
+        list_proc->prox = enter_processes(&list_arena, 2, 2, 1, 0); tmp_proc = list_proc->prox;
+        tmp_proc->prox  = enter_processes(&list_arena, 3,  8, 4, 0); tmp_proc = tmp_proc->prox;
+        tmp_proc->prox  = enter_processes(&list_arena, 4,  10, 3, 0);
         esc = menu();
     }
     else if(es_proc==2){
@@ -409,6 +458,7 @@ int main(){
         printf("\n\n  OBS: Preferably choose for more than 3 processes.");
         printf("\n\n   Introduce the number of processes: ");
         scanf("%d", &n_proc);
+        arena_reset(&list_arena);
         for(i=0; i<n_proc;i++){
             system("cls");
             top();
@@ -417,16 +467,18 @@ int main(){
             scanf("%d", &dur);
             printf("Introduce your execution priority P[%d]: ", i+1);
             scanf("%d", &prio);
+            printf("Introduce the arrival time P[%d]: ", i+1);
+            scanf("%d", &arr);
             if(i==0)
-                list_proc = enter_processes(i+1, dur, prio);
+                list_proc = enter_processes(&list_arena, i+1, dur, prio, arr);
             else if(i==1){
-                list_proc->prox = enter_processes(i+1, dur, prio); tmp_proc = list_proc->prox;
+                list_proc->prox = enter_processes(&list_arena, i+1, dur, prio, arr); tmp_proc = list_proc->prox;
             }
             else if(i==n_proc-1){
-                tmp_proc->prox  = enter_processes(i+1,  dur, prio);
+                tmp_proc->prox  = enter_processes(&list_arena, i+1,  dur, prio, arr);
             }
             else{
-                tmp_proc->prox  = enter_processes(i+1,  dur, prio); tmp_proc = tmp_proc->prox;
+                tmp_proc->prox  = enter_processes(&list_arena, i+1,  dur, prio, arr); tmp_proc = tmp_proc->prox;
             }
         }
         posi=1;
@@ -436,7 +488,10 @@ int main(){
     if(esc == 1){
         system("cls");
         list_processes(list_proc);
-        fcfs(list_proc, n_proc);
+        printf("\n\t\t First-Come, First-Serve (FCFS)\n\n");
+        fcfs(list_proc, &sched);
+        print_schedule(&sched, n_proc);
+        print_gantt(&sched);
         printf("\n\n\t< 1 > Go back\nChoice: ");
         int i;
         scanf("%d", &i);
@@ -444,8 +499,10 @@ int main(){
     else if ( esc == 2){
         system("cls");
         list_processes(list_proc);
-        sjf(list_proc, n_proc);
-        sjf_simulator(list_proc, n_proc);
+        printf("\n\t\tShortest-Job-First- (SRTF)\n\n ");
+        sjf(list_proc, &work_arena, &sched);
+        print_schedule(&sched, n_proc);
+        print_gantt(&sched);
         printf("\n\n\t< 1 > Go back\nChoice: ");
         int i;
         scanf("%d", &i);
@@ -453,8 +510,10 @@ int main(){
     else if (esc == 3){
         system("cls");
         list_processes(list_proc);
-        scheduling_priority(list_proc, n_proc);
-        scheduling_priority_simulator(list_proc, n_proc);
+        printf("\n\t\tPriority scheduler \n\n");
+        scheduling_priority(list_proc, &work_arena, &sched);
+        print_schedule(&sched, n_proc);
+        print_gantt(&sched);
         printf("\n\n\t< 1 > Go back\nChoice: ");
         int i;
         scanf("%d", &i);
@@ -463,15 +522,21 @@ int main(){
         system("cls");
         int quantum;
         list_processes(list_proc);
-        printf("\nTime quantum: ");
-        scanf("%d", &quantum);
-        robbin_round(list_proc, quantum, n_proc);
+        do{
+            printf("\nTime quantum: ");
+            scanf("%d", &quantum);
+        }while(quantum < 1);
+        tmp_proc = robbin_round(list_proc, &work_arena, quantum, &sched);
+        print_round_robin(tmp_proc, &sched, quantum);
         printf("\n\n\t< 1 > Go back\n Your choice: ");
         int i;
         scanf("%d", &i);
     }
     else if( esc == 5){
         printf("\n\nProgram terminates.\n\n");
+        free(sched.slices);
+        arena_release(&work_arena);
+        arena_release(&list_arena);
         exit(2);
     }
     }while(esc <= 6);
@@ -0,0 +1,157 @@
+/* classes.h - process classes
+ *
+ * A class is a run of identical processes arriving at a steady rate,
+ * described in one line and made into processes only as a run needs them.
+ */
+#ifndef CLASSES_H
+#define CLASSES_H
+
+#include "engine.h"
+
+namespace engine {
+
+// Process classes
+// count processes, pids pid, pid + 1, ..., arriving every interval cycles
+// from arrival on; a plain workload line is a class of one
+class ProcessClass{
+public:
+  int pid;
+  long long arrival;
+  int burst;
+  int priority;
+  long long count;
+  long long interval;
+};
+
+// Reads a class workload, "class pid arrival burst priority count
+// interval" and plain "pid arrival burst priority" lines in any order.
+// Lines with fewer fields are skipped.
+void loadClasses(istream& is, vector<ProcessClass>& classes){
+  string text;
+  while(getline(is, text)){
+    ProcessClass aClass;
+    aClass.count = 1;
+    aClass.interval = 0;
+    if(sscanf(text.c_str(), " class %d %lld %d %d %lld %lld", &aClass.pid, &aClass.arrival, &aClass.burst,
+              &aClass.priority, &aClass.count, &aClass.interval) == 6
+       || sscanf(text.c_str(), "%d %lld %d %d", &aClass.pid, &aClass.arrival, &aClass.burst, &aClass.priority) == 4){
+      if(aClass.count > 0 && aClass.interval >= 0){
+        classes.push_back(aClass);
+      }
+    }
+  }
+}
+
+// Members of a set of classes in arrival order, ties going to the class
+// listed first, handed out a class at a time
+class ClassMerge{
+public:
+  ClassMerge(const vector<ProcessClass>& classesVal){
+    classes = &classesVal;
+    taken.assign(classesVal.size(), 0);
+    for(int c=0; c < (int)classesVal.size(); c++){
+      heads.push(make_pair(classesVal[c].arrival, c));
+    }
+  };
+
+  bool empty(){
+    return heads.empty();
+  };
+
+  // Takes up to most members of the class arriving next, no more than
+  // arrive before another class' next member; returns the class, with
+  // the index of the first member taken in first and their number in
+  // members
+  int next(long long most, long long& first, long long& members){
+    int c = heads.top().second;
+    long long arrival = heads.top().first;
+    const ProcessClass& aClass = (*classes)[c];
+    heads.pop();
+    first = taken[c];
+    members = aClass.count - first;
+    if(!heads.empty() && aClass.interval > 0){
+      long long gap = heads.top().first - arrival;
+      members = min(members, c < heads.top().second?gap / aClass.interval + 1:(gap + aClass.interval - 1) / aClass.interval);
+    }
+    members = max(1LL, min(members, most));
+    taken[c] += members;
+    if(taken[c] < aClass.count){
+      heads.push(make_pair(aClass.arrival + taken[c] * aClass.interval, c));
+    }
+    return c;
+  };
+
+private:
+  const vector<ProcessClass>* classes;
+  vector<long long> taken;
+  priority_queue<pair<long long, int>, vector<pair<long long, int> >, greater<pair<long long, int> > > heads;
+};
+
+// Members of a class workload as processes, one at a time, for the runs
+// that step them
+class ClassArrivals : public ArrivalSource{
+public:
+  ClassArrivals(const vector<ProcessClass>& classesVal) : merge(classesVal){
+    classes = &classesVal;
+  };
+
+  bool next(Process& arriving){
+    long long first, members;
+    if(merge.empty()){
+      return false;
+    }
+    const ProcessClass& aClass = (*classes)[merge.next(1, first, members)];
+    arriving = Process(aClass.pid + (int)first, (int)(aClass.arrival + first * aClass.interval), aClass.burst, aClass.priority);
+    return true;
+  };
+
+private:
+  const vector<ProcessClass>* classes;
+  ClassMerge merge;
+};
+
+// First-come first-served run of a class workload, a segment (members
+// with no other class arriving in between) at a time. Member k of a
+// segment every d cycles with burst b waits max(0, wait + k(b - d)),
+// summed in closed form. Adds the totals to stats unless it is NULL and
+// returns the cycles the run takes.
+long long runClassesFCFS(const vector<ProcessClass>& classes, StatsSink* stats, long long& processes, long long& segments){
+  ClassMerge merge(classes);
+  long long lastCompletion = -1;
+  processes = segments = 0;
+  while(!merge.empty()){
+    long long first, m;
+    const ProcessClass& aClass = classes[merge.next(numeric_limits<long long>::max(), first, m)];
+    long long arrival = aClass.arrival + first * aClass.interval;
+    long long b = aClass.burst;
+    long long d = aClass.interval;
+    long long wait = processes > 0?max(0LL, lastCompletion - arrival):0;
+    // Waits are summed in floating point, m(m-1)/2 overflows long before m does
+    double waits;
+    long long longest;
+    if(b >= d){
+      waits = m * (double)wait + (double)(b - d) * m * (m - 1) / 2;
+      longest = wait + (m - 1) * (b - d);
+    }else{
+      long long waiting = min(m, (wait + d - b - 1) / (d - b));
+      waits = waiting * (double)wait - (double)(d - b) * waiting * (waiting - 1) / 2;
+      longest = wait;
+    }
+    lastCompletion = arrival + (m - 1) * d + max(0LL, wait + (m - 1) * (b - d)) + b;
+    processes += m;
+    segments++;
+    if(stats != NULL){
+      stats->count += m;
+      stats->wait += waits;
+      stats->turnaround += waits + (double)m * b;
+      stats->response += waits;
+      stats->slowdown += (waits + (double)m * b) / max(1LL, b);
+      stats->maxTurnaround = max(stats->maxTurnaround, (int)(longest + b));
+    }
+  }
+  return lastCompletion + 1;
+}
+
+}
+
+#endif
@@ -0,0 +1,570 @@
+/* cluster.h - multi-node cluster simulation
+ *
+ * A dispatcher places each arriving process on one of several nodes, each
+ * a Simulation of its own, and idle nodes may steal waiting processes.
+ */
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "topology.h"
+#include "numa.h"
+
+namespace engine {
+
+// Cluster simulation
+// Nodes step together; an idle node may steal the last waiting process
+// of another, the move's cost added to its burst
+enum Placement{
+  PLACE_RANDOM = 1,
+  PLACE_SHORTEST_QUEUE,
+  PLACE_TWO_CHOICES,
+  PLACE_LEAST_LOADED
+};
+
+// Placement names of batch jobs and records
+const char* placementNames[] = {"", "random", "jsq", "p2c", "least"};
+
+int parsePlacement(const string& name){
+  for(int i=PLACE_RANDOM; i <= PLACE_LEAST_LOADED; i++){
+    if(name == placementNames[i] || name == to_string(i)){
+      return i;
+    }
+  }
+  return 0;
+}
+
+// Per node load, backlog and waiting processes promised to other nodes
+class ClusterView{
+public:
+  vector<int> load;
+  vector<long long> backlog;
+  vector<int> taken;
+};
+
+// A planned migration of the last waiting process of victim to node,
+// the distance between them and what the move costs the process
+class Steal{
+public:
+  int node;
+  int victim;
+  int pid;
+  int distance;
+  int cost;
+  // Cycles of the cost due to the NUMA stretch, negative nearer home
+  int stretched;
+};
+
+class ClusterNode{
+public:
+  Simulation sim;
+  // Cycles of work placed on the node and not run yet
+  long long backlog;
+  long long busyCycles;
+  int migratedIn;
+};
+
+class Cluster{
+public:
+  Cluster(const vector<Process>& arrivalOrder, int nodeCount, int policyVal, int timeQuantum,
+          int placementVal, int migrationCostVal, unsigned seed){
+    arrivals = arrivalOrder;
+    nextArrival = 0;
+    time = 0;
+    migrations = 0;
+    policy = policyVal;
+    placement = placementVal;
+    migrationCost = migrationCostVal;
+    random.seed(seed);
+    affinity = AFFINITY_NONE;
+    topology.cores = nodeCount;
+    waker = -1;
+    remoteStretch = numaUnit;
+    numaAware = false;
+    numaCycles = 0;
+    fill(migrationsAt, migrationsAt + DISTANCES, 0);
+    nodes.resize(nodeCount);
+    for(int i=0; i < nodeCount; i++){
+      nodes[i].sim = Simulation(vector<Process>(), policyVal, timeQuantum);
+      nodes[i].backlog = 0;
+      nodes[i].busyCycles = 0;
+      nodes[i].migratedIn = 0;
+    }
+  };
+
+  vector<Process> arrivals;
+  int nextArrival;
+  int time;
+  int migrations;
+  int policy;
+  int placement;
+  // Cycles a migration costs, negative turns migration off
+  int migrationCost;
+  vector<ClusterNode> nodes;
+  // Cores the nodes stand for, flat unless set before the run
+  Topology topology;
+  int affinity;
+  // Core each pid last ran on and first ran on
+  map<int, int> lastCore;
+  map<int, int> homeCore;
+  // Node of the latest completion, -1 before the first
+  int waker;
+  // Processes started at each distance from their last core, steals and
+  // returning processes alike
+  long long migrationsAt[DISTANCES];
+  // Slowdown of a memory bound burst away from its home node, in
+  // numaUnits, whether placement and steals go by it, and the cycles it
+  // added to bursts, less those taken off going back home
+  int remoteStretch;
+  bool numaAware;
+  long long numaCycles;
+
+  bool done(){
+    if(nextArrival < (int)arrivals.size()){
+      return false;
+    }
+    for(int i=0; i < (int)nodes.size(); i++){
+      if(!nodes[i].sim.done()){
+        return false;
+      }
+    }
+    return true;
+  };
+
+  void step();
+  void stepNode(int i);
+  void viewNodes(ClusterView& view);
+  int place(ClusterView& view, Process& arriving);
+  void planSteals(ClusterView& view, vector<Steal>& steals);
+  void moved(int pid, int node, int distance, int stretched);
+  int stretch(const Process& aProcess, int core);
+
+private:
+  mt19937 random;
+  void balance();
+  int placeAffine(ClusterView& view, int last);
+  int placeHome(ClusterView& view, const Process& arriving);
+  bool mayRun(int pid, int node);
+};
+
+// View of the nodes as they stand between two cycles
+void Cluster::viewNodes(ClusterView& view){
+  view.load.resize(nodes.size());
+  view.backlog.resize(nodes.size());
+  view.taken.assign(nodes.size(), 0);
+  for(int i=0; i < (int)nodes.size(); i++){
+    view.load[i] = nodes[i].sim.inSystem();
+    view.backlog[i] = nodes[i].backlog;
+  }
+}
+
+// Node a new process goes to, ties to the lower numbered node
+int Cluster::place(ClusterView& view, Process& arriving){
+  int n = (int)nodes.size();
+  int best = 0;
+  map<int, int>::iterator last = lastCore.find(arriving.pid);
+  int home = numaAware?placeHome(view, arriving):-1;
+  if(affinity == AFFINITY_HARD && last != lastCore.end()){
+    // The least loaded core of its home LLC group, ties going nearest
+    int firstCore = homeCore[arriving.pid];
+    best = last->second;
+    for(int i=0; i < n; i++){
+      if(topology.distance(firstCore, i) <= DISTANCE_LLC
+         && (view.load[i] < view.load[best]
+             || (view.load[i] == view.load[best] && topology.distance(last->second, i) < topology.distance(last->second, best)))){
+        best = i;
+      }
+    }
+  }else if(affinity != AFFINITY_NONE && (last != lastCore.end() || (affinity == AFFINITY_WAKE && waker >= 0))){
+    best = placeAffine(view, last != lastCore.end()?last->second:waker);
+  }else if(home >= 0){
+    best = home;
+  }else if(placement == PLACE_RANDOM){
+    best = random() % n;
+  }else if(placement == PLACE_TWO_CHOICES){
+    if(n > 1){
+      int a = random() % n;
+      int b = random() % (n - 1);
+      b += b >= a?1:0;
+      best = view.load[b] < view.load[a] || (view.load[b] == view.load[a] && b < a)?b:a;
+    }
+  }else if(placement == PLACE_LEAST_LOADED){
+    for(int i=1; i < n; i++){
+      if(view.backlog[i] < view.backlog[best]){
+        best = i;
+      }
+    }
+  }else{
+    for(int i=1; i < n; i++){
+      if(view.load[i] < view.load[best]){
+        best = i;
+      }
+    }
+  }
+  int stretched = restretch(arriving.burst, numaUnit, stretch(arriving, best));
+  numaCycles += stretched - arriving.burst;
+  arriving.burst = stretched;
+  if(last != lastCore.end()){
+    int distance = topology.distance(last->second, best);
+    arriving.burst += topology.cost[distance];
+    migrationsAt[distance]++;
+  }else{
+    homeCore[arriving.pid] = best;
+  }
+  lastCore[arriving.pid] = best;
+  view.load[best]++;
+  view.backlog[best] += arriving.burst;
+  return best;
+}
+
+// Soft or wake-affine choice of core for a process last on core last
+int Cluster::placeAffine(ClusterView& view, int last){
+  int n = (int)nodes.size();
+  int best = last;
+  if(affinity == AFFINITY_WAKE){
+    if(view.load[last] == 0){
+      return last;
+    }
+    for(int i=0; i < n; i++){
+      if(view.load[i] == 0 && topology.distance(last, i) <= DISTANCE_LLC
+         && (view.load[best] > 0 || topology.distance(last, i) < topology.distance(last, best))){
+        best = i;
+      }
+    }
+    return best;
+  }
+  int least = *min_element(view.load.begin(), view.load.end());
+  if(view.load[last] <= least + 1){
+    return last;
+  }
+  for(int i=0; i < n; i++){
+    if(view.load[i] == least && (view.load[best] > least || topology.distance(last, i) < topology.distance(last, best))){
+      best = i;
+    }
+  }
+  return best;
+}
+
+// Least loaded core of the home node of arriving, by backlog with least
+// loaded placement, or -1 if it has no home or every core there has more
+// than one process above the least loaded core anywhere
+int Cluster::placeHome(ClusterView& view, const Process& arriving){
+  int n = (int)nodes.size();
+  if(arriving.home < 0 || arriving.home >= topology.sockets || arriving.memory == 0){
+    return -1;
+  }
+  int perNode = n / topology.sockets;
+  int best = arriving.home * perNode;
+  for(int i=best + 1; i < (arriving.home + 1) * perNode; i++){
+    if(placement == PLACE_LEAST_LOADED?view.backlog[i] < view.backlog[best]:view.load[i] < view.load[best]){
+      best = i;
+    }
+  }
+  return view.load[best] <= *min_element(view.load.begin(), view.load.end()) + 1?best:-1;
+}
+
+// Stretch of the burst of aProcess on core, numaUnit at home
+int Cluster::stretch(const Process& aProcess, int core){
+  if(remoteStretch == numaUnit || aProcess.home < 0 || aProcess.home >= topology.sockets
+     || topology.numaNode(core) == aProcess.home){
+    return numaUnit;
+  }
+  return numaUnit + (remoteStretch - numaUnit) * aProcess.memory / 100;
+}
+
+// Whether the process pid may be moved to node
+bool Cluster::mayRun(int pid, int node){
+  return affinity != AFFINITY_HARD || topology.distance(homeCore[pid], node) <= DISTANCE_LLC;
+}
+
+// Records pid starting on node, distance away from where it last ran,
+// its burst changed by stretched cycles on the way
+void Cluster::moved(int pid, int node, int distance, int stretched){
+  lastCore[pid] = node;
+  numaCycles += stretched;
+  migrationsAt[distance]++;
+  migrations++;
+}
+
+// Every idle node takes the last waiting process of the longest queue,
+// if the work ahead of it there outweighs the migration
+void Cluster::planSteals(ClusterView& view, vector<Steal>& steals){
+  bool anyQueued = false;
+  for(int i=0; i < (int)nodes.size(); i++){
+    if(view.load[i] > 0){
+      continue;
+    }
+    int victim = -1;
+    bool victimLocal = false;
+    anyQueued = false;
+    for(int k=0; k < (int)nodes.size(); k++){
+      int queued = nodes[k].sim.queued() - view.taken[k];
+      anyQueued = anyQueued || queued > 0;
+      if(queued <= 0 || !mayRun(nodes[k].sim.lastQueued(view.taken[k]).pid, i)){
+        continue;
+      }
+      Process& tail = nodes[k].sim.lastQueued(view.taken[k]);
+      bool local = !numaAware || stretch(tail, i) <= stretch(tail, k);
+      int nearer = victim < 0?-1:topology.distance(i, victim) - topology.distance(i, k);
+      if(victim >= 0 && local != victimLocal){
+        if(local){
+          victim = k;
+          victimLocal = local;
+        }
+        continue;
+      }
+      if(victim < 0 || (affinity != AFFINITY_NONE && nearer > 0)
+         || ((affinity == AFFINITY_NONE || nearer == 0) && queued > nodes[victim].sim.queued() - view.taken[victim])){
+        victim = k;
+        victimLocal = local;
+      }
+    }
+    if(!anyQueued){
+      return;
+    }
+    if(victim < 0){
+      continue;
+    }
+    Process& stolen = nodes[victim].sim.lastQueued(view.taken[victim]);
+    int remaining = stolen.remainingCycles();
+    int distance = topology.distance(victim, i);
+    int stretched = restretch(remaining, stretch(stolen, victim), stretch(stolen, i)) - remaining;
+    int cost = migrationCost + topology.cost[distance] + stretched;
+    if(view.backlog[victim] - remaining <= (numaAware?cost:cost - stretched)){
+      continue;
+    }
+    Steal steal;
+    steal.node = i;
+    steal.victim = victim;
+    steal.pid = stolen.pid;
+    steal.distance = distance;
+    steal.cost = cost;
+    steal.stretched = stretched;
+    steals.push_back(steal);
+    view.taken[victim]++;
+    view.load[victim]--;
+    view.backlog[victim] -= remaining;
+    view.load[i]++;
+    view.backlog[i] += remaining + cost;
+  }
+}
+
+// Stolen processes arrive on their new nodes the next cycle
+void Cluster::balance(){
+  ClusterView view;
+  vector<Steal> steals;
+  viewNodes(view);
+  planSteals(view, steals);
+  for(int s=0; s < (int)steals.size(); s++){
+    ClusterNode& node = nodes[steals[s].node];
+    Process moved;
+    nodes[steals[s].victim].sim.migrateOut(moved);
+    nodes[steals[s].victim].backlog -= moved.remainingCycles();
+    node.backlog += moved.remainingCycles() + steals[s].cost;
+    // Unlike a fresh arrival, it waits in the cycle it is admitted
+    moved.enters = node.sim.time;
+    moved.wait++;
+    moved.burst += steals[s].cost;
+    node.sim.arrivals.push_back(moved);
+    node.migratedIn++;
+    this->moved(steals[s].pid, steals[s].node, steals[s].distance, steals[s].stretched);
+  }
+}
+
+// One cycle of node i
+void Cluster::stepNode(int i){
+  // A process on the cpu at the start of a cycle runs for all of it
+  if(nodes[i].sim.runningPid() != -1){
+    nodes[i].busyCycles++;
+    nodes[i].backlog--;
+  }
+  nodes[i].sim.step(NULL);
+}
+
+void Cluster::step(){
+  if(nextArrival < (int)arrivals.size() && arrivals[nextArrival].arrival == time){
+    ClusterView view;
+    viewNodes(view);
+    while(nextArrival < (int)arrivals.size() && arrivals[nextArrival].arrival == time){
+      ClusterNode& node = nodes[place(view, arrivals[nextArrival])];
+      node.sim.arrivals.push_back(arrivals[nextArrival]);
+      node.backlog += arrivals[nextArrival].burst;
+      nextArrival++;
+    }
+  }
+  for(int i=0; i < (int)nodes.size(); i++){
+    size_t completed = nodes[i].sim.completed.size();
+    stepNode(i);
+    if(nodes[i].sim.completed.size() != completed){
+      waker = i;
+    }
+  }
+  time++;
+  if(migrationCost >= 0){
+    balance();
+  }
+}
+
+void runCluster(Cluster& cluster){
+  profileReset();
+  while(!cluster.done()){
+    cluster.step();
+  }
+}
+
+// Node i writes to track i, tracks must outlive the run
+void traceCluster(Cluster& cluster, TraceEvents* trace, vector<TraceTrack>& tracks){
+  tracks.resize(cluster.nodes.size());
+  for(int i=0; i < (int)cluster.nodes.size(); i++){
+    tracks[i] = TraceTrack(trace, i, "node " + to_string(i));
+    cluster.nodes[i].sim.track = &tracks[i];
+  }
+}
+
+// Latency of a set of finished processes
+class LatencySummary{
+public:
+  int processes;
+  double meanWait;
+  double meanTurnaround;
+  int p50;
+  int p90;
+  int p99;
+  int longest;
+};
+
+LatencySummary summarizeLatency(const vector<Process>& finished){
+  LatencySummary summary;
+  vector<int> turnaround;
+  long waitTotal = 0;
+  long turnaroundTotal = 0;
+  for(int i=0; i < (int)finished.size(); i++){
+    waitTotal += finished[i].wait;
+    turnaroundTotal += finished[i].wait + finished[i].completedCycles;
+    turnaround.push_back(finished[i].wait + finished[i].completedCycles);
+  }
+  sort(turnaround.begin(), turnaround.end());
+  double n = finished.empty()?1:finished.size();
+  summary.processes = (int)finished.size();
+  summary.meanWait = waitTotal / n;
+  summary.meanTurnaround = turnaroundTotal / n;
+  summary.p50 = percentileOf(turnaround, 50);
+  summary.p90 = percentileOf(turnaround, 90);
+  summary.p99 = percentileOf(turnaround, 99);
+  summary.longest = turnaround.empty()?0:turnaround.back();
+  return summary;
+}
+
+const report_column clusterColumns[] = {
+  {"node", "Node", 0}, {"busy", "Busy %", 0}, {"in", "In", 0}, {"out", "Out", 0}, {"processes", "Processes", 0},
+  {"wait", "Wait", 0}, {"turnaround", "Turnaround", 0}, {"p50", "p50", 0}, {"p90", "p90", 0}, {"p99", "p99", 0},
+  {"max", "Max", 0}
+};
+
+// Row of a node, or of all of them, of the cluster table
+void reportClusterRow(report& out, const string& node, long long busy, int in, int moved, const LatencySummary& summary){
+  report_text(&out, node.c_str());
+  report_int(&out, busy);
+  report_int(&out, in);
+  report_int(&out, moved);
+  report_int(&out, summary.processes);
+  report_real(&out, summary.meanWait, -1);
+  report_real(&out, summary.meanTurnaround, -1);
+  report_int(&out, summary.p50);
+  report_int(&out, summary.p90);
+  report_int(&out, summary.p99);
+  report_int(&out, summary.longest);
+}
+
+const report_column distanceColumns[] = {
+  {"distance", "Distance", 0}, {"cost", "Cost", 0}, {"migrations", "Migrations", 0}
+};
+
+// Processes started at each distance from their last core
+void printDistances(Cluster& cluster, ostream& os){
+  const Topology& topology = cluster.topology;
+  string title = "Topology: " + to_string(topology.sockets) + " socket(s) of " + to_string(topology.llcs)
+                 + " LLC group(s) of " + to_string(topology.l2s) + " L2 group(s) of " + to_string(topology.cores)
+                 + " core(s), " + affinityNames[cluster.affinity] + " affinity\n";
+  report out;
+  report_begin(&out, reportToStream, &os, "distances", distanceColumns, 3, REPORT_TABS);
+  report_title(&out, title.c_str());
+  for(int d=DISTANCE_CORE; d < DISTANCES; d++){
+    report_text(&out, distanceNames[d]);
+    report_int(&out, topology.cost[d]);
+    report_int(&out, cluster.migrationsAt[d]);
+  }
+  report_end(&out);
+}
+
+void printClusterResults(Cluster& cluster, ostream& os){
+  vector<Process> all;
+  long long busy = 0;
+  long long cycles = max(1, cluster.time);
+  string title = "Cluster Results: " + to_string(cluster.nodes.size()) + " nodes, " + policyName(cluster.policy)
+                 + ", " + placementNames[cluster.placement] + " placement, migration "
+                 + (cluster.migrationCost < 0?string("off"):"cost " + to_string(cluster.migrationCost)) + "\n";
+  report out;
+  report_begin(&out, reportToStream, &os, "cluster", clusterColumns, 11, REPORT_TABS);
+  report_title(&out, title.c_str());
+  for(int i=0; i < (int)cluster.nodes.size(); i++){
+    ClusterNode& node = cluster.nodes[i];
+    reportClusterRow(out, to_string(i), 100 * node.busyCycles / cycles, node.migratedIn, node.sim.migratedOut,
+                     summarizeLatency(node.sim.completed));
+    all.insert(all.end(), node.sim.completed.begin(), node.sim.completed.end());
+    busy += node.busyCycles;
+  }
+  reportClusterRow(out, "all", 100 * busy / (cycles * cluster.nodes.size()), cluster.migrations, cluster.migrations,
+                   summarizeLatency(all));
+  report_value_int(&out, "cycles", "Cycles: ", cluster.time);
+  report_end(&out);
+  if(cluster.topology.described || cluster.affinity != AFFINITY_NONE){
+    printDistances(cluster, os);
+  }
+  if(report_human(&out)){
+    printProfile(os, "cluster");
+  }else{
+#ifndef NO_PROFILE
+    appendProfileJSON("cluster");
+#endif
+  }
+  os.flush();
+}
+
+const report_column numaColumns[] = {
+  {"balance", "Balancing", 0}, {"cycles", "Cycles", 0}, {"throughput", "Throughput", 0}, {"wait", "Wait", 0},
+  {"p50", "p50", 0}, {"p99", "p99", 0}, {"numa_cycles", "NUMA Cycles", 0}
+};
+
+// Naive and NUMA aware balancing of the same workload side by side, the
+// throughput in processes per 1000 cycles
+void printNumaComparison(const vector<Process>& arrivals, const Topology& topology, double factor,
+                         int policy, int timeQuantum, int migrationCost, ostream& os){
+  report out;
+  report_begin(&out, reportToStream, &os, "numa", numaColumns, 7, REPORT_TABS);
+  report_title(&out, "NUMA balancing\n");
+  for(int aware=0; aware < 2; aware++){
+    Cluster cluster(arrivals, topology.coreCount(), policy, timeQuantum, PLACE_SHORTEST_QUEUE, migrationCost, 1);
+    cluster.topology = topology;
+    cluster.remoteStretch = (int)(factor * numaUnit + 0.5);
+    cluster.numaAware = aware;
+    runCluster(cluster);
+    vector<Process> all;
+    for(int i=0; i < (int)cluster.nodes.size(); i++){
+      all.insert(all.end(), cluster.nodes[i].sim.completed.begin(), cluster.nodes[i].sim.completed.end());
+    }
+    LatencySummary summary = summarizeLatency(all);
+    report_text(&out, balanceNames[aware]);
+    report_int(&out, cluster.time);
+    report_real(&out, 1000.0 * summary.processes / max(1, cluster.time), 2);
+    report_real(&out, summary.meanWait, 2);
+    report_int(&out, summary.p50);
+    report_int(&out, summary.p99);
+    report_int(&out, cluster.numaCycles);
+  }
+  report_end(&out);
+  os.flush();
+}
+
+}
+
+#endif
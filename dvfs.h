@@ -0,0 +1,177 @@
+/* dvfs.h - cpu frequency scaling
+ *
+ * A cpu runs at one of several frequency states, each a speed and the power
+ * it draws busy. The cpu banks its speed every busy cycle and the running
+ * process advances a cycle of its burst per whole cycle banked. Ondemand
+ * goes by the busy share of the last period, schedutil by a decaying
+ * utilisation. States above the power cap are never picked, unless all
+ * are, and an idle cycle draws idlePower.
+ */
+#ifndef DVFS_H
+#define DVFS_H
+
+#include <cmath>
+#include "workload.h"
+
+namespace engine {
+
+// Frequency scaling
+// Speeds are in dvfsUnits of the fastest state; a governor picks the state
+// every dvfsPeriod cycles
+const int dvfsUnit = 1024;
+const int dvfsPeriod = 10;
+const int dvfsUpThreshold = 80;
+
+enum Governor{
+  GOVERNOR_PERFORMANCE,
+  GOVERNOR_POWERSAVE,
+  GOVERNOR_ONDEMAND,
+  GOVERNOR_SCHEDUTIL,
+  GOVERNORS
+};
+
+// Governor names of batch jobs and records
+const char* governorNames[] = {"performance", "powersave", "ondemand", "schedutil"};
+
+int parseGovernor(const string& name){
+  for(int i=GOVERNOR_PERFORMANCE; i < GOVERNORS; i++){
+    if(name == governorNames[i] || name == to_string(i)){
+      return i;
+    }
+  }
+  return -1;
+}
+
+class FrequencyState{
+public:
+  int speed;
+  double power;
+};
+
+bool slowerState(const FrequencyState& a, const FrequencyState& b){
+  return a.speed < b.speed;
+}
+
+// States of a cpu whose busy power grows with the cube of its speed,
+// on top of a fixed part, 1000 at full speed
+vector<FrequencyState> defaultStates(){
+  double speeds[] = {0.4, 0.6, 0.8, 1.0};
+  vector<FrequencyState> states;
+  for(int i=0; i < 4; i++){
+    FrequencyState state;
+    state.speed = (int)(speeds[i] * dvfsUnit + 0.5);
+    state.power = 100 + 900 * speeds[i] * speeds[i] * speeds[i];
+    states.push_back(state);
+  }
+  return states;
+}
+
+// Parses "SPEED:POWER,...", speeds as fractions of the fastest, in any
+// order; false unless every speed is above 0 and at most 1
+bool parseStates(const string& text, vector<FrequencyState>& states){
+  string spaced = text;
+  replace(spaced.begin(), spaced.end(), ',', ' ');
+  replace(spaced.begin(), spaced.end(), ':', ' ');
+  stringstream ss(spaced);
+  double speed, power;
+  states.clear();
+  while(ss >> speed >> power){
+    FrequencyState state;
+    state.speed = (int)(speed * dvfsUnit + 0.5);
+    state.power = power;
+    if(state.speed < 1 || state.speed > dvfsUnit || power < 0){
+      return false;
+    }
+    states.push_back(state);
+  }
+  sort(states.begin(), states.end(), slowerState);
+  return ss.eof() && !states.empty();
+}
+
+class Dvfs{
+public:
+  Dvfs(const vector<FrequencyState>& statesVal, int governorVal, double idlePowerVal, double cap){
+    // No states at all gets defaultStates() rather than a cpu with none
+    const vector<FrequencyState>& offered = statesVal.empty()?defaultStates():statesVal;
+    for(int i=0; i < (int)offered.size(); i++){
+      if(offered[i].power <= cap){
+        states.push_back(offered[i]);
+      }
+    }
+    if(states.empty()){
+      states.push_back(offered[0]);
+    }
+    governor = governorVal;
+    idlePower = idlePowerVal;
+    state = governor == GOVERNOR_POWERSAVE?0:(int)states.size() - 1;
+    bank = 0;
+    cycles = 0;
+    busyInPeriod = 0;
+    busyCycles = 0;
+    utilization = 0;
+    energy = 0;
+    decay = pow(0.5, 1 / 32.0);
+  };
+
+  // States the cap leaves, slowest first, and the one the cpu is in
+  vector<FrequencyState> states;
+  int governor;
+  double idlePower;
+  int state;
+  int bank;
+  long long cycles;
+  int busyInPeriod;
+  long long busyCycles;
+  double utilization;
+  double energy;
+  // Weight of the utilisation a cycle ago, halving it every 32 cycles
+  double decay;
+
+  // Whether the process busy on the cpu this cycle, if there is one,
+  // gets a cycle of its burst done
+  bool tick(bool busy){
+    if(cycles > 0 && cycles % dvfsPeriod == 0){
+      choose();
+    }
+    cycles++;
+    energy += busy?states[state].power:idlePower;
+    utilization = utilization * decay + (busy?(1 - decay) * states[state].speed / dvfsUnit:0);
+    if(!busy){
+      return false;
+    }
+    busyInPeriod++;
+    busyCycles++;
+    bank += states[state].speed;
+    if(bank < dvfsUnit){
+      return false;
+    }
+    bank -= dvfsUnit;
+    return true;
+  };
+
+private:
+  // Slowest state at least target fast, or the fastest
+  int slowestAtLeast(double target){
+    for(int i=0; i < (int)states.size(); i++){
+      if(states[i].speed >= target){
+        return i;
+      }
+    }
+    return (int)states.size() - 1;
+  };
+
+  void choose(){
+    int fastest = states.back().speed;
+    if(governor == GOVERNOR_ONDEMAND){
+      int load = busyInPeriod * 100 / dvfsPeriod;
+      state = load > dvfsUpThreshold?(int)states.size() - 1:slowestAtLeast((double)load * fastest / 100);
+    }else if(governor == GOVERNOR_SCHEDUTIL){
+      state = slowestAtLeast(1.25 * utilization * dvfsUnit);
+    }
+    busyInPeriod = 0;
+  };
+};
+
+}
+
+#endif
@@ -0,0 +1,1449 @@
+/* engine.h - scheduling engine of OS.cpp
+ *
+ * The processes, the policies and every kind of run the menu and batch
+ * mode offer, without either of them, so OS.cpp, harness.cpp and
+ * procsim.cpp all build the same engine. Everything is defined here and in
+ * the headers it includes, in namespace engine, so a program includes it
+ * in one source file only.
+ */
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <iostream>
+#include <string>
+#include <queue>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iterator>
+#include <deque>
+#include <cstdio>
+#include <map>
+#include <limits>
+#include <thread>
+#include <atomic>
+#include <random>
+#include <cstring>
+#include <mutex>
+#include <cmath>
+#include <numeric>
+#include "profile.h"
+#include "metrics.h"
+#include "report.h"
+#include "trace.h"
+#include "workload.h"
+#include "estimate.h"
+#include "dvfs.h"
+
+namespace engine {
+
+using namespace std;
+
+// RunColumns lays the finished processes of one or more runs out column
+// by column, as metrics.h takes them, so the times of every run are
+// worked out in a single pass instead of one Process at a time
+class RunColumns{
+public:
+  RunColumns(){
+    offsets.push_back(0);
+  };
+
+  // Adds a run, its index is runs() - 1
+  void add(const vector<Process>& processes){
+    for(int i=0; i < (int)processes.size(); i++){
+      arrival.push_back(processes[i].arrival);
+      firstRun.push_back(processes[i].firstRun);
+      completion.push_back(processes[i].completion);
+      burst.push_back(processes[i].burst);
+    }
+    offsets.push_back((int)arrival.size());
+  };
+
+  int runs() const{
+    return (int)offsets.size() - 1;
+  };
+
+  // Sums of each run, and with perProcess the times of each process in
+  // wait, turnaround, response and slowdown
+  vector<metrics_run> compute(bool perProcess){
+    int n = perProcess?(int)arrival.size():0;
+    wait.resize(n);
+    turnaround.resize(n);
+    response.resize(n);
+    slowdown.resize(n);
+    metrics_columns columns = {arrival.data(), firstRun.data(), completion.data(), burst.data(),
+                               perProcess?wait.data():NULL, perProcess?turnaround.data():NULL,
+                               perProcess?response.data():NULL, perProcess?slowdown.data():NULL};
+    vector<metrics_run> sums(runs());
+    metrics_compute(&columns, offsets.data(), runs(), sums.data());
+    return sums;
+  };
+
+  vector<int> arrival;
+  vector<int> firstRun;
+  vector<int> completion;
+  vector<int> burst;
+  vector<int> offsets;
+  vector<int> wait;
+  vector<int> turnaround;
+  vector<int> response;
+  vector<float> slowdown;
+};
+
+const report_column resultColumns[] = {
+  {"pid", "PID", 0}, {"wait", "Wait", 0}, {"turnaround", "Turnaround", 0},
+  {"response", "Response", 0}, {"slowdown", "Slowdown", 0}
+};
+
+// Results as a table, or as CSV or JSON when REPORT_FORMAT asks for it,
+// in which case the profile only goes to PROFILE_JSON. Given a policy,
+// the queueing estimates of it follow, with their error against the run.
+void printResults(vector<Process> processes, ostream& os, const char* label = "run", int policy = 0){
+  RunColumns columns;
+  columns.add(processes);
+  metrics_run sums = columns.compute(true)[0];
+  long n = (long)processes.size();
+  report out;
+  report_begin(&out, reportToStream, &os, label, resultColumns, 5, REPORT_TABS);
+  report_title(&out, "Performance Results\n");
+  /* cast to int */
+  for(long i=0; i < n; i++){
+    report_id(&out, "P", processes[i].pid);
+    report_int(&out, columns.wait[i]);
+    report_int(&out, columns.turnaround[i]);
+    report_int(&out, columns.response[i]);
+    report_real(&out, columns.slowdown[i], 2);
+  }
+  report_value_int(&out, "average_wait", "Average Wait Time: ", (long)sums.wait / n);
+  report_value_int(&out, "average_turnaround", "Average Turnarount Time: ", (long)sums.turnaround / n);
+  report_value_int(&out, "average_response", "Average Response Time: ", (long)sums.response / n);
+  report_value_real(&out, "average_slowdown", "Average Slowdown: ", sums.slowdown / n, 2);
+  if(policy != 0){
+    QueueEstimate estimate = estimateQueue(fitWorkload(processes), policy);
+    report_value_real(&out, "estimated_wait", "Estimated Wait Time: ", estimate.wait, 2);
+    report_value_real(&out, "wait_error", "Wait Estimate Error (%): ", estimateError(estimate.wait, sums.wait / n), 1);
+    report_value_real(&out, "estimated_turnaround", "Estimated Turnaround Time: ", estimate.turnaround, 2);
+    report_value_real(&out, "turnaround_error", "Turnaround Estimate Error (%): ",
+                      estimateError(estimate.turnaround, sums.turnaround / n), 1);
+  }
+  report_end(&out);
+  if(report_human(&out)){
+    printProfile(os, label);
+  }else{
+#ifndef NO_PROFILE
+    appendProfileJSON(label);
+#endif
+  }
+  os.flush();
+}
+
+// Completion sinks and arrival sources
+// Given a CompletionSink a run hands over each process as it completes
+// instead of keeping it, given an ArrivalSource it reads arrivals a
+// window at a time.
+
+class CompletionSink{
+public:
+  virtual ~CompletionSink(){};
+  virtual void complete(const Process& finished) = 0;
+};
+
+// Keeps nothing, the run still counts what it completed
+class DiscardSink : public CompletionSink{
+public:
+  void complete(const Process&){};
+};
+
+// Writes a "pid arrival burst priority wait first_run completion" line
+// per completed process
+class FileSink : public CompletionSink{
+public:
+  FileSink(ostream& osVal){
+    os = &osVal;
+  };
+
+  void complete(const Process& finished){
+    *os << finished.pid << ' ' << finished.arrival << ' ' << finished.burst << ' ' << finished.priority << ' '
+        << finished.wait << ' ' << finished.firstRun << ' ' << finished.completion << '\n';
+  };
+
+private:
+  ostream* os;
+};
+
+// Sums completed processes a block at a time through the metrics kernel
+const int statsBlock = 1024;
+
+class StatsSink : public CompletionSink{
+public:
+  StatsSink(){
+    used = 0;
+    count = 0;
+    wait = turnaround = response = slowdown = 0;
+    maxTurnaround = 0;
+  };
+
+  void complete(const Process& finished){
+    arrival[used] = finished.arrival;
+    firstRun[used] = finished.firstRun;
+    completion[used] = finished.completion;
+    burst[used] = finished.burst;
+    if(++used == statsBlock){
+      flush();
+    }
+  };
+
+  // Adds the block gathered so far to the totals
+  void flush(){
+    metrics_columns columns = {arrival, firstRun, completion, burst, NULL, NULL, NULL, NULL};
+    metrics_run run;
+    metrics_range(&columns, 0, used, &run);
+    count += run.count;
+    wait += run.wait;
+    turnaround += run.turnaround;
+    response += run.response;
+    slowdown += run.slowdown;
+    maxTurnaround = max(maxTurnaround, run.max_turnaround);
+    used = 0;
+  };
+
+  long long count;
+  double wait;
+  double turnaround;
+  double response;
+  double slowdown;
+  int maxTurnaround;
+
+private:
+  int used;
+  int arrival[statsBlock];
+  int firstRun[statsBlock];
+  int completion[statsBlock];
+  int burst[statsBlock];
+};
+
+class ArrivalSource{
+public:
+  virtual ~ArrivalSource(){};
+  // Next process in arrival order, false once there are no more
+  virtual bool next(Process& arriving) = 0;
+};
+
+// Reads a workload file in arrival order a line at a time, stopping at
+// a line that arrives before the one above it and setting outOfOrder, or
+// at a process that is not runnable() and setting badProcess
+class StreamArrivals : public ArrivalSource{
+public:
+  StreamArrivals(istream& isVal){
+    is = &isVal;
+    last = 0;
+    outOfOrder = false;
+    badProcess = false;
+  };
+
+  bool next(Process& arriving){
+    int pid, arrival, burst, priority;
+    while(!outOfOrder && !badProcess && getline(*is, text)){
+      if(sscanf(text.c_str(), "%d %d %d %d", &pid, &arrival, &burst, &priority) < 4){
+        continue;
+      }
+      if(!runnable(Process(pid, arrival, burst, priority))){
+        badProcess = true;
+        return false;
+      }
+      if(arrival < last){
+        outOfOrder = true;
+        return false;
+      }
+      last = arrival;
+      arriving = Process(pid, arrival, burst, priority);
+      readNumaFields(text, arriving);
+      return true;
+    }
+    return false;
+  };
+
+  bool outOfOrder;
+  bool badProcess;
+
+private:
+  istream* is;
+  string text;
+  int last;
+};
+
+// Arrivals a streamed run holds at a time
+const int streamWindow = 4096;
+
+// Process in flight at a snapshot: its place in the run's arrivals and
+// the fields the run changes
+class SnapshotEntry{
+public:
+  int index;
+  int wait;
+  int completedCycles;
+  int firstRun;
+};
+
+// Snapshot is a lightweight copy of the in-flight part of a Simulation.
+// Arrivals and completed processes are not copied, only their counts: the
+// run the snapshot was taken from still holds them.
+class Snapshot{
+public:
+  int time;
+  int nextArrival;
+  int contiguousCycles;
+  int completedCount;
+  vector<SnapshotEntry> waiting;
+  vector<SnapshotEntry> cpu;
+};
+
+SnapshotEntry snapshotEntry(const Process& aProcess, int index){
+  SnapshotEntry entry = {index, aProcess.wait, aProcess.completedCycles, aProcess.firstRun};
+  return entry;
+}
+
+// Process an entry stands for, given the arrivals of the run it came from
+Process snapshotProcess(const SnapshotEntry& entry, const vector<Process>& arrivals){
+  Process aProcess = arrivals[entry.index];
+  aProcess.wait = entry.wait;
+  aProcess.completedCycles = entry.completedCycles;
+  aProcess.firstRun = entry.firstRun;
+  return aProcess;
+}
+
+// Checkpoint settings, 0 cycles turns checkpointing off
+string checkpointFile = "checkpoint.bin";
+int checkpointInterval = 0;
+
+// Simulation holds the complete state of one scheduler run, so a run can
+// be advanced a clock cycle at a time and saved or restored in between
+class Simulation{
+public:
+  Simulation(){};
+
+  Simulation(priority_queue<Process> processes, int policyVal, int timeQuantumVal){
+    // Arrival order is fixed once, the queue pops in the same order it always did
+    while(!processes.empty()){
+      arrivals.push_back(processes.top());
+      processes.pop();
+    }
+    reset(policyVal, timeQuantumVal);
+  };
+
+  Simulation(const vector<Process>& arrivalOrder, int policyVal, int timeQuantumVal){
+    arrivals = arrivalOrder;
+    reset(policyVal, timeQuantumVal);
+  };
+
+  int policy;
+  int timeQuantum;
+  int contiguousCycles;
+  int time;
+  bool useAging;
+  vector<Process> arrivals;
+  int nextArrival;
+  ProcessQueue waiting;
+  vector<Process> cpu;
+  vector<Process> completed;
+  // Round robin keeps its processes in table instead, where they stay
+  // put: the ready queue and running hold indices into it. A queued
+  // process' wait is settled when it leaves the queue, from readySince,
+  // the cycle it joined it. waiting and cpu only show these processes
+  // after syncQueues(). Slots of processes that completed or moved away
+  // are listed in freeSlots and taken by the next arrivals.
+  vector<Process> table;
+  vector<int> readySince;
+  vector<int> freeSlots;
+  RunQueue ready;
+  int running;
+  // Processes moved to another run by migrateOut()
+  int migratedOut;
+  // Track the run's events are exported to, NULL if they are not
+  TraceTrack* track;
+  // Sink completed processes go to instead of completed, NULL to keep
+  // them; sunk counts those handed over
+  CompletionSink* sink;
+  long long sunk;
+  // Source a streamed run takes its arrivals from, NULL if there is none
+  // or it ran out. arrivals then only holds the window being read and
+  // streamed counts the arrivals of the windows before it.
+  ArrivalSource* source;
+  long long streamed;
+  // Frequency scaling of the cpu, NULL to run at full speed throughout
+  Dvfs* dvfs;
+
+  bool done(){
+    return (long long)completed.size() + sunk + migratedOut == streamed + (long long)arrivals.size() && source == NULL;
+  };
+
+  void step(ostream* log);
+  bool save(const string& path);
+  bool load(const string& path);
+  Snapshot snapshot(const map<int, int>& positions);
+  void resume(const Snapshot& aSnapshot, const vector<Process>& arrivalsBefore, ArrivalSource* sourceVal);
+  bool matches(const Snapshot& aSnapshot, const vector<Process>& arrivalsBefore);
+  int runningPid();
+  void syncQueues();
+  int queued();
+  Process& lastQueued(int skip = 0);
+  int inSystem();
+  bool migrateOut(Process& moved);
+  void streamFrom(ArrivalSource* sourceVal);
+
+private:
+  string event;
+  bool logging;
+  // Whether the running process gets a cycle done this cycle
+  bool advance;
+  void reset(int policyVal, int timeQuantumVal);
+  void note(int pid, const char* what);
+  void sortWaiting();
+  void dispatch();
+  void preempt(int i);
+  void stepQueues();
+  void stepRoundRobin();
+  void dispatchNext();
+  void adoptQueues();
+  void finish(const Process& finished);
+  void arrived();
+  void refill();
+};
+
+void Simulation::reset(int policyVal, int timeQuantumVal){
+  policy = policyVal;
+  timeQuantum = timeQuantumVal;
+  contiguousCycles = 0;
+  time = 0;
+  useAging = Process::UseAging();
+  nextArrival = 0;
+  table.clear();
+  readySince.clear();
+  ready.clear();
+  running = -1;
+  migratedOut = 0;
+  track = NULL;
+  freeSlots.clear();
+  sink = NULL;
+  sunk = 0;
+  source = NULL;
+  streamed = 0;
+  dvfs = NULL;
+}
+
+// Completed process kept, or handed to the sink
+void Simulation::finish(const Process& finished){
+  if(sink != NULL){
+    sink->complete(finished);
+    sunk++;
+  }else{
+    completed.push_back(finished);
+  }
+}
+
+// Moves past the arrival just taken, reading the next window of a
+// streamed run once this one is used up
+void Simulation::arrived(){
+  nextArrival++;
+  if(source != NULL && nextArrival == (int)arrivals.size()){
+    refill();
+  }
+}
+
+void Simulation::refill(){
+  streamed += nextArrival;
+  arrivals.clear();
+  nextArrival = 0;
+  Process arriving;
+  while((int)arrivals.size() < streamWindow && source->next(arriving)){
+    arrivals.push_back(arriving);
+  }
+  if(arrivals.empty()){
+    source = NULL;
+  }
+}
+
+// Takes the arrivals of the run from sourceVal, as the clock reaches them,
+// instead of from arrivals
+void Simulation::streamFrom(ArrivalSource* sourceVal){
+  arrivals.clear();
+  nextArrival = 0;
+  streamed = 0;
+  source = sourceVal;
+  refill();
+}
+
+// Adds an event to the clock cycle's log line, if the run is logged
+void Simulation::note(int pid, const char* what){
+  if(logging){
+    event = event + "P" + to_string(pid) + what;
+  }
+}
+
+void Simulation::sortWaiting(){
+  if(policy == POLICY_SRTF){
+    waiting.sortByRemainingTime(waiting);
+    PROFILE_COUNT(sorts);
+  }else if(policy == POLICY_PRIORITY || policy == POLICY_PREEMPTIVE_PRIORITY){
+    waiting.sortByPriority(waiting);
+    PROFILE_COUNT(sorts);
+  }
+}
+
+// New process put on cpu
+void Simulation::dispatch(){
+  note(waiting.front().pid, " put on CPU; ");
+  if(waiting.front().firstRun < 0){
+    waiting.front().firstRun = time;
+  }
+  if(track != NULL){
+    track->dispatch(waiting.front().pid, time);
+  }
+  PROFILE_COUNT(dispatches);
+  cpu.push_back(waiting.front());
+  waiting.pop();
+}
+
+// Running process swapped with the head of the waiting queue
+void Simulation::preempt(int i){
+  note(cpu[i].pid, " taken off CPU; ");
+  PROFILE_COUNT(preemptions);
+  if(track != NULL){
+    track->preempt(cpu[i].pid, time);
+  }
+  waiting.push(cpu[i]);
+  cpu.erase(cpu.begin()+i);
+  dispatch();
+  sortWaiting();
+}
+
+// Simulates one clock cycle, logging its events to log unless it is NULL
+void Simulation::step(ostream* log){
+  Process::setUseAging(useAging);
+  logging = log != NULL;
+  event = "";
+  PROFILE_START();
+  PROFILE_COUNT(cycles);
+  // A process on the cpu at the start of the cycle runs at its speed
+  advance = dvfs == NULL || dvfs->tick(policy == POLICY_RR?running >= 0:!cpu.empty());
+  if(policy == POLICY_RR){
+    stepRoundRobin();
+  }else{
+    stepQueues();
+  }
+  PROFILE_LAP(PHASE_CPU);
+  // Output events for clock cycle
+  if(logging){
+    *log << time << "\t" << event << endl;
+    PROFILE_LAP(PHASE_LOG);
+  }
+  // New clock cycle
+  time++;
+}
+
+// One cycle of the policies that order the waiting queue
+void Simulation::stepQueues(){
+  // Waiting processes wait values incremented
+  waiting.incrementWaits(waiting);
+  PROFILE_LAP(PHASE_WAITS);
+  // Processes arrive
+  while(nextArrival < (int)arrivals.size() && arrivals[nextArrival].enters == time){
+    note(arrivals[nextArrival].pid, " arrives; ");
+    PROFILE_COUNT(arrivals);
+    if(track != NULL){
+      track->arrive(arrivals[nextArrival].pid, time);
+    }
+    waiting.push(arrivals[nextArrival]);
+    arrived();
+  }
+  PROFILE_HIGH(waitingHighWater, waiting.size());
+  PROFILE_LAP(PHASE_ARRIVALS);
+  sortWaiting();
+  PROFILE_LAP(PHASE_SORT);
+  if(cpu.empty()){
+    if(!waiting.empty()){
+      dispatch();
+    }else{
+      PROFILE_COUNT(idleCycles);
+    }
+  }else{
+    /* cast to int */
+    for(int i=0; i < (int)cpu.size(); i++){
+      // Cpu processes are incremented, unless a slowed cpu got no whole
+      // cycle done
+      if(advance){
+        cpu[i].completedCycles++;
+      }
+      // If current process completed
+      if(cpu[i].completedCycles == cpu[i].burst){
+        note(cpu[i].pid, " completed; ");
+        PROFILE_COUNT(completions);
+        cpu[i].completion = time;
+        if(track != NULL){
+          track->complete(time);
+        }
+        finish(cpu[i]);
+        cpu.erase(cpu.begin() + i);
+        if(!waiting.empty()){
+          dispatch();
+          contiguousCycles = 0;
+        }
+      }else if(!waiting.empty()){
+        if(policy == POLICY_SRTF && cpu[i].remainingCycles() > waiting.front().remainingCycles()){
+          preempt(i);
+        }else if(policy == POLICY_PREEMPTIVE_PRIORITY && cpu[i].priorityWithWindchill() > waiting.front().priorityWithWindchill()){
+          preempt(i);
+        }
+      }
+    }
+  }
+}
+
+// Head of the ready queue put on cpu, its wait settled up to this cycle
+void Simulation::dispatchNext(){
+  int i = ready.front();
+  ready.pop();
+  table[i].wait += time - readySince[i];
+  if(table[i].firstRun < 0){
+    table[i].firstRun = time;
+  }
+  if(track != NULL){
+    track->dispatch(table[i].pid, time);
+  }
+  note(table[i].pid, " put on CPU; ");
+  PROFILE_COUNT(dispatches);
+  running = i;
+}
+
+// One round robin cycle. A process that joins the ready queue in this
+// cycle starts waiting from the next one, as in stepQueues().
+void Simulation::stepRoundRobin(){
+  // Processes arrive
+  while(nextArrival < (int)arrivals.size() && arrivals[nextArrival].enters == time){
+    note(arrivals[nextArrival].pid, " arrives; ");
+    PROFILE_COUNT(arrivals);
+    if(track != NULL){
+      track->arrive(arrivals[nextArrival].pid, time);
+    }
+    int slot = (int)table.size();
+    if(freeSlots.empty()){
+      table.push_back(arrivals[nextArrival]);
+      readySince.push_back(time);
+    }else{
+      slot = freeSlots.back();
+      freeSlots.pop_back();
+      table[slot] = arrivals[nextArrival];
+      readySince[slot] = time;
+    }
+    ready.push(slot);
+    arrived();
+  }
+  PROFILE_HIGH(waitingHighWater, ready.size());
+  PROFILE_LAP(PHASE_ARRIVALS);
+  if(running < 0){
+    if(!ready.empty()){
+      dispatchNext();
+      contiguousCycles = 0;
+    }else{
+      PROFILE_COUNT(idleCycles);
+    }
+    return;
+  }
+  Process& current = table[running];
+  if(advance){
+    current.completedCycles++;
+  }
+  contiguousCycles++;
+  if(current.completedCycles == current.burst){
+    note(current.pid, " completed; ");
+    PROFILE_COUNT(completions);
+    current.completion = time;
+    if(track != NULL){
+      track->complete(time);
+    }
+    finish(current);
+    freeSlots.push_back(running);
+    running = -1;
+    if(!ready.empty()){
+      dispatchNext();
+      contiguousCycles = 0;
+    }
+  }else if(contiguousCycles >= timeQuantum && ready.empty()){
+    // Quantum expired with nothing waiting, the process starts a new one
+    contiguousCycles = 0;
+  }else if(contiguousCycles >= timeQuantum){
+    // Quantum expired, the process goes to the back of the queue
+    note(current.pid, " taken off CPU; ");
+    PROFILE_COUNT(preemptions);
+    if(track != NULL){
+      track->preempt(current.pid, time);
+    }
+    readySince[running] = time;
+    ready.push(running);
+    dispatchNext();
+    contiguousCycles = 0;
+  }
+}
+
+int Simulation::runningPid(){
+  if(policy == POLICY_RR){
+    return running < 0?-1:table[running].pid;
+  }
+  return cpu.empty()?-1:cpu[0].pid;
+}
+
+// Processes waiting for the cpu
+int Simulation::queued(){
+  return policy == POLICY_RR?ready.size():(int)waiting.size();
+}
+
+// Process migrateOut() would take after skip others, only valid while
+// queued() > skip
+Process& Simulation::lastQueued(int skip){
+  return policy == POLICY_RR?table[ready.at(ready.size() - 1 - skip)]:waiting.fromBack(waiting, skip);
+}
+
+// Processes given to this run and not finished or moved away yet,
+// including those still to arrive
+int Simulation::inSystem(){
+  return (int)(streamed + (long long)arrivals.size() - (long long)completed.size() - sunk - migratedOut);
+}
+
+// Takes the last waiting process off this run, between two cycles, so
+// it can be added to another one; false if nothing is waiting
+bool Simulation::migrateOut(Process& moved){
+  if(policy == POLICY_RR){
+    if(ready.empty()){
+      return false;
+    }
+    int i = ready.back();
+    ready.popBack();
+    moved = table[i];
+    moved.wait += time - 1 - readySince[i];
+    freeSlots.push_back(i);
+  }else{
+    if(waiting.empty()){
+      return false;
+    }
+    moved = waiting.popBack(waiting);
+  }
+  if(track != NULL){
+    track->migrate(moved.pid, time);
+  }
+  migratedOut++;
+  return true;
+}
+
+// Fills waiting and cpu from the round robin table, with waits as they
+// stand between two cycles. Other policies keep them up to date anyway.
+void Simulation::syncQueues(){
+  if(policy != POLICY_RR){
+    return;
+  }
+  waiting = ProcessQueue();
+  for(int k=0; k < ready.size(); k++){
+    Process queued = table[ready.at(k)];
+    queued.wait += time - 1 - readySince[ready.at(k)];
+    waiting.push(queued);
+  }
+  cpu.clear();
+  if(running >= 0){
+    cpu.push_back(table[running]);
+  }
+}
+
+// Rebuilds the round robin table from waiting and cpu, the reverse of
+// syncQueues()
+void Simulation::adoptQueues(){
+  if(policy != POLICY_RR){
+    return;
+  }
+  deque<Process> queued = waiting.contents(waiting);
+  table.assign(queued.begin(), queued.end());
+  readySince.assign(queued.size(), time - 1);
+  freeSlots.clear();
+  ready.clear();
+  for(int i=0; i < (int)queued.size(); i++){
+    ready.push(i);
+  }
+  running = -1;
+  if(!cpu.empty()){
+    table.push_back(cpu[0]);
+    readySince.push_back(time);
+    running = (int)table.size() - 1;
+  }
+}
+
+// Checkpoint file layout: magic, version, engine registers, then the
+// arrival list, waiting queue, cpu and completed vectors as counted
+// arrays of process records. All values are native 32 bit integers.
+const int checkpointMagic = 0x4d495350; // "PSIM"
+// Version 2: round robin checkpoints hold a FIFO ready queue
+// Version 3: process records end with the first run and completion cycles
+const int checkpointVersion = 3;
+
+void writeInt(ostream& os, int value){
+  os.write((const char*)&value, sizeof(value));
+}
+
+int readInt(istream& is){
+  int value = 0;
+  is.read((char*)&value, sizeof(value));
+  return value;
+}
+
+void writeProcesses(ostream& os, const deque<Process>& processes){
+  writeInt(os, (int)processes.size());
+  for(int i=0; i < (int)processes.size(); i++){
+    writeInt(os, processes[i].pid);
+    writeInt(os, processes[i].arrival);
+    writeInt(os, processes[i].burst);
+    writeInt(os, processes[i].priority);
+    writeInt(os, processes[i].wait);
+    writeInt(os, processes[i].completedCycles);
+    writeInt(os, processes[i].firstRun);
+    writeInt(os, processes[i].completion);
+  }
+}
+
+deque<Process> readProcesses(istream& is){
+  deque<Process> processes;
+  int count = readInt(is);
+  for(int i=0; i < count && is; i++){
+    Process aProcess;
+    aProcess.pid = readInt(is);
+    aProcess.arrival = readInt(is);
+    aProcess.enters = aProcess.arrival;
+    aProcess.burst = readInt(is);
+    aProcess.priority = readInt(is);
+    aProcess.wait = readInt(is);
+    aProcess.completedCycles = readInt(is);
+    aProcess.firstRun = readInt(is);
+    aProcess.completion = readInt(is);
+    processes.push_back(aProcess);
+  }
+  return processes;
+}
+
+// Written to a temporary file first, so an interrupted save never
+// replaces the last good checkpoint
+bool Simulation::save(const string& path){
+  string tmpPath = path + ".tmp";
+  syncQueues();
+  ofstream out(tmpPath.c_str(), ios::binary | ios::trunc);
+  writeInt(out, checkpointMagic);
+  writeInt(out, checkpointVersion);
+  writeInt(out, policy);
+  writeInt(out, timeQuantum);
+  writeInt(out, contiguousCycles);
+  writeInt(out, time);
+  writeInt(out, useAging);
+  writeInt(out, nextArrival);
+  writeProcesses(out, deque<Process>(arrivals.begin() + nextArrival, arrivals.end()));
+  writeProcesses(out, waiting.contents(waiting));
+  writeProcesses(out, deque<Process>(cpu.begin(), cpu.end()));
+  writeProcesses(out, deque<Process>(completed.begin(), completed.end()));
+  out.close();
+  if(!out){
+    return false;
+  }
+  return rename(tmpPath.c_str(), path.c_str()) == 0;
+}
+
+bool Simulation::load(const string& path){
+  ifstream in(path.c_str(), ios::binary);
+  if(!in || readInt(in) != checkpointMagic || readInt(in) != checkpointVersion){
+    return false;
+  }
+  policy = readInt(in);
+  timeQuantum = readInt(in);
+  contiguousCycles = readInt(in);
+  time = readInt(in);
+  useAging = readInt(in) != 0;
+  nextArrival = readInt(in);
+  migratedOut = 0;
+  track = NULL;
+  sink = NULL;
+  source = NULL;
+  sunk = streamed = 0;
+  // Arrivals already consumed are not stored, only their count
+  deque<Process> pending = readProcesses(in);
+  arrivals.assign(nextArrival, Process(0, 0, 0, 0));
+  arrivals.insert(arrivals.end(), pending.begin(), pending.end());
+  deque<Process> queued = readProcesses(in);
+  waiting = ProcessQueue();
+  for(int i=0; i < (int)queued.size(); i++){
+    waiting.push(queued[i]);
+  }
+  deque<Process> running = readProcesses(in);
+  cpu.assign(running.begin(), running.end());
+  deque<Process> finished = readProcesses(in);
+  completed.assign(finished.begin(), finished.end());
+  adoptQueues();
+  return (bool)in;
+}
+
+// Snapshot of the run, positions giving the place of each pid in its
+// arrivals
+Snapshot Simulation::snapshot(const map<int, int>& positions){
+  Snapshot aSnapshot;
+  syncQueues();
+  aSnapshot.time = time;
+  aSnapshot.nextArrival = nextArrival;
+  aSnapshot.contiguousCycles = contiguousCycles;
+  aSnapshot.completedCount = (int)completed.size();
+  deque<Process> queued = waiting.contents(waiting);
+  for(int i=0; i < (int)queued.size(); i++){
+    aSnapshot.waiting.push_back(snapshotEntry(queued[i], positions.find(queued[i].pid)->second));
+  }
+  for(int i=0; i < (int)cpu.size(); i++){
+    aSnapshot.cpu.push_back(snapshotEntry(cpu[i], positions.find(cpu[i].pid)->second));
+  }
+  return aSnapshot;
+}
+
+// Resumes from a snapshot of a run whose arrivals were arrivalsBefore,
+// taking the arrivals still to come from sourceVal. The processes in
+// flight count as read already; completed only gets those completing
+// from here on.
+void Simulation::resume(const Snapshot& aSnapshot, const vector<Process>& arrivalsBefore, ArrivalSource* sourceVal){
+  time = aSnapshot.time;
+  contiguousCycles = aSnapshot.contiguousCycles;
+  waiting = ProcessQueue();
+  for(int i=0; i < (int)aSnapshot.waiting.size(); i++){
+    waiting.push(snapshotProcess(aSnapshot.waiting[i], arrivalsBefore));
+  }
+  cpu.clear();
+  for(int i=0; i < (int)aSnapshot.cpu.size(); i++){
+    cpu.push_back(snapshotProcess(aSnapshot.cpu[i], arrivalsBefore));
+  }
+  completed.clear();
+  adoptQueues();
+  streamFrom(sourceVal);
+  streamed = (long long)(aSnapshot.waiting.size() + aSnapshot.cpu.size());
+}
+
+bool sameState(const Process& a, const Process& b){
+  return a.pid == b.pid && a.arrival == b.arrival && a.burst == b.burst && a.priority == b.priority
+    && a.wait == b.wait && a.completedCycles == b.completedCycles && a.firstRun == b.firstRun;
+}
+
+// True when the in-flight state equals the snapshot's, so from here on
+// this run repeats the run the snapshot was taken from
+bool Simulation::matches(const Snapshot& aSnapshot, const vector<Process>& arrivalsBefore){
+  if(time != aSnapshot.time){
+    return false;
+  }
+  syncQueues();
+  deque<Process> queued = waiting.contents(waiting);
+  if(contiguousCycles != aSnapshot.contiguousCycles || queued.size() != aSnapshot.waiting.size()
+     || cpu.size() != aSnapshot.cpu.size()){
+    return false;
+  }
+  for(int i=0; i < (int)queued.size(); i++){
+    if(!sameState(queued[i], snapshotProcess(aSnapshot.waiting[i], arrivalsBefore))){
+      return false;
+    }
+  }
+  for(int i=0; i < (int)cpu.size(); i++){
+    if(!sameState(cpu[i], snapshotProcess(aSnapshot.cpu[i], arrivalsBefore))){
+      return false;
+    }
+  }
+  return true;
+}
+
+// Arrivals of a baseline from first on with one process moved: the one
+// at removed is left out and changed comes just before the one at
+// insertBefore
+class OverlayArrivals : public ArrivalSource{
+public:
+  OverlayArrivals(const vector<Process>& baseVal, int first, int removedVal, int insertBeforeVal, const Process& changedVal){
+    base = &baseVal;
+    at = first;
+    removed = removedVal;
+    insertBefore = insertBeforeVal;
+    changed = changedVal;
+    inserted = false;
+  };
+
+  bool next(Process& arriving){
+    if(at == removed){
+      at++;
+    }
+    if(!inserted && at == insertBefore){
+      inserted = true;
+      arriving = changed;
+      return true;
+    }
+    if(at == (int)base->size()){
+      return false;
+    }
+    arriving = (*base)[at++];
+    return true;
+  };
+
+private:
+  const vector<Process>* base;
+  int at;
+  int removed;
+  int insertBefore;
+  Process changed;
+  bool inserted;
+};
+
+// A finished run plus the snapshots taken along the way, reused by every
+// what-if question asked about the same workload and scheduler
+class WhatIfBaseline{
+public:
+  Simulation finished;
+  vector<Snapshot> snapshots;
+  // Place of each pid in the arrivals of finished
+  map<int, int> positions;
+  int interval;
+};
+
+int whatIfInterval = 64;
+
+// A pid arriving twice could not be told apart in a snapshot, so such a
+// workload only gets the snapshot at cycle 0 and questions rerun it whole
+WhatIfBaseline recordBaseline(priority_queue<Process> processes, int policy, int timeQuantum, int interval){
+  WhatIfBaseline baseline;
+  baseline.interval = interval;
+  baseline.finished = Simulation(processes, policy, timeQuantum);
+  const vector<Process>& arrivals = baseline.finished.arrivals;
+  bool unique = true;
+  for(int i=0; i < (int)arrivals.size(); i++){
+    unique = baseline.positions.insert(make_pair(arrivals[i].pid, i)).second && unique;
+  }
+  while(!baseline.finished.done()){
+    if(baseline.finished.time % interval == 0 && (unique || baseline.finished.time == 0)){
+      baseline.snapshots.push_back(baseline.finished.snapshot(baseline.positions));
+    }
+    baseline.finished.step(NULL);
+  }
+  return baseline;
+}
+
+// Completions of a what-if question: the baseline's up to before, the
+// re-simulated ones, then the baseline's from after on. The baseline's
+// are kept by reference, only completed() copies them.
+class WhatIfResult{
+public:
+  const vector<Process>* baseline;
+  int before;
+  vector<Process> resimulated;
+  int after;
+  int time;
+
+  vector<Process> completed() const{
+    vector<Process> all(baseline->begin(), baseline->begin() + before);
+    all.insert(all.end(), resimulated.begin(), resimulated.end());
+    all.insert(all.end(), baseline->begin() + after, baseline->end());
+    return all;
+  };
+};
+
+int averageWait(const vector<Process>& processes){
+  int waitTotal = 0;
+  for(int i=0; i < (int)processes.size(); i++){
+    waitTotal += processes[i].wait;
+  }
+  return processes.empty()?0:waitTotal / (int)processes.size();
+}
+
+bool arrivesEarlier(const Process& a, const Process& b){
+  return a.arrival < b.arrival;
+}
+
+bool snapshotAfter(int time, const Snapshot& aSnapshot){
+  return time < aSnapshot.time;
+}
+
+// Re-simulates the baseline workload with one process changed. The run
+// resumes from the last snapshot before the change can matter, reading
+// the baseline's arrivals with the process moved, and stops as soon as
+// its state matches a baseline snapshot again. A question costs the
+// cycles re-simulated, not the size of the workload.
+WhatIfResult whatIf(const WhatIfBaseline& baseline, const Process& changed, ostream& os){
+  profileReset();
+  const vector<Process>& before = baseline.finished.arrivals;
+  WhatIfResult result;
+  result.baseline = &baseline.finished.completed;
+  result.before = result.after = (int)baseline.finished.completed.size();
+  result.time = baseline.finished.time;
+  if(changed.burst < 1 || changed.arrival < 0){
+    os << "A burst must be at least 1 and an arrival at least 0" << endl;
+    return result;
+  }
+  map<int, int>::const_iterator found = baseline.positions.find(changed.pid);
+  if(found == baseline.positions.end()){
+    os << "No process P" << changed.pid << " in the workload" << endl;
+    return result;
+  }
+  int index = found->second;
+  // The process moves behind everything arriving no later than it, ties
+  // between the others keep their order
+  int position = (int)(upper_bound(before.begin(), before.end(), changed, arrivesEarlier) - before.begin());
+  position -= before[index].arrival <= changed.arrival?1:0;
+  if(changed.arrival == before[index].arrival){
+    position = index;
+  }
+  int divergence = min(changed.arrival, before[index].arrival);
+  int settled = max(changed.arrival, before[index].arrival);
+  int start = (int)(upper_bound(baseline.snapshots.begin(), baseline.snapshots.end(), divergence, snapshotAfter)
+                    - baseline.snapshots.begin()) - 1;
+  const Snapshot& from = baseline.snapshots[start];
+  OverlayArrivals arrivals(before, from.nextArrival, index, position < index?position:position + 1,
+                           Process(changed.pid, changed.arrival, changed.burst, changed.priority));
+  Simulation sim(vector<Process>(), baseline.finished.policy, baseline.finished.timeQuantum);
+  sim.useAging = baseline.finished.useAging;
+  sim.resume(from, before, &arrivals);
+  long long inFlight = sim.streamed;
+  result.before = from.completedCount;
+  os << "Resuming from cycle " << sim.time << " of " << baseline.finished.time << endl;
+  int next = start + 1;
+  while(!sim.done()){
+    sim.step(NULL);
+    while(next < (int)baseline.snapshots.size() && baseline.snapshots[next].time < sim.time){
+      next++;
+    }
+    if(next < (int)baseline.snapshots.size() && baseline.snapshots[next].time == sim.time && sim.time > settled
+       && from.nextArrival + sim.streamed - inFlight + sim.nextArrival == baseline.snapshots[next].nextArrival
+       && sim.matches(baseline.snapshots[next], before)){
+      os << "Reconverged with the baseline at cycle " << sim.time << endl;
+      result.resimulated.swap(sim.completed);
+      result.after = baseline.snapshots[next].completedCount;
+      return result;
+    }
+  }
+  os << "Ran to completion at cycle " << sim.time << endl;
+  result.resimulated.swap(sim.completed);
+  result.time = sim.time;
+  return result;
+}
+
+// Runs a simulation to the end, checkpointing every checkpointInterval cycles
+void runSimulation(Simulation& sim, ostream& os){
+  TraceEvents* trace = openTraceEvents(policyName(sim.policy));
+  vector<TraceTrack> tracks;
+  if(trace != NULL){
+    tracks.push_back(TraceTrack(trace, 0, "CPU"));
+    sim.track = &tracks[0];
+    // A resumed run starts with its process already on the cpu
+    if(sim.runningPid() != -1){
+      tracks[0].dispatch(sim.runningPid(), sim.time);
+    }
+  }
+  profileReset();
+  if(sim.time == 0){
+    os << "Running the " << policyName(sim.policy) << " scheduler..." << endl;
+  }else{
+    os << "Resuming the " << policyName(sim.policy) << " scheduler at cycle " << sim.time << "..." << endl;
+  }
+  os << "Time\tEvent" << endl;
+  while(!sim.done()){
+    sim.step(&os);
+    if(checkpointInterval > 0 && sim.time % checkpointInterval == 0 && !sim.save(checkpointFile)){
+      cout << "Could not write checkpoint " << checkpointFile << endl;
+    }
+  }
+  os << "******************** End simulation ************************" << endl;
+  if(trace != NULL){
+    finishTrace(trace, tracks, sim.time);
+    sim.track = NULL;
+  }
+  printResults(sim.completed, os, policyName(sim.policy), sim.policy);
+}
+
+void scheduleFCFS(priority_queue<Process> processes, ostream& os){
+  Simulation sim(processes, POLICY_FCFS, 0);
+  runSimulation(sim, os);
+}
+
+void scheduleSRTF(priority_queue<Process> processes, ostream& os){
+  Simulation sim(processes, POLICY_SRTF, 0);
+  runSimulation(sim, os);
+}
+
+void schedulePriority(priority_queue<Process> processes, ostream& os){
+  Simulation sim(processes, POLICY_PRIORITY, 0);
+  runSimulation(sim, os);
+}
+
+void schedulePreemptivePriority(priority_queue<Process> processes, ostream& os){
+  Simulation sim(processes, POLICY_PREEMPTIVE_PRIORITY, 0);
+  runSimulation(sim, os);
+}
+
+void scheduleRR(priority_queue<Process> processes, ostream& os, int timeQuantum){
+  Simulation sim(processes, POLICY_RR, timeQuantum);
+  runSimulation(sim, os);
+}
+
+// Round robin quantum tuning
+// Searches the quantum that minimises an objective, coarse to fine: a
+// grid of quanta is simulated in parallel, then a grid a quarter as
+// coarse is laid around the best one, until quanta are 1 apart. Every few
+// cycles a run compares a lower bound of its final cost with the best
+// cost found so far and gives up once it can no longer win. The bounds
+// only grow as the run goes on (waits never shrink, switches only add
+// up), so the quantum chosen is the same as without the cutoff.
+enum TuneObjective{
+  TUNE_MEAN_WAIT = 1,
+  TUNE_P99_TURNAROUND,
+  TUNE_MIXED
+};
+
+const char* tuneObjectiveName(int objective){
+  static const char* names[] = {"", "mean wait", "p99 turnaround", "mean wait with switch penalty"};
+  return (objective >= TUNE_MEAN_WAIT && objective <= TUNE_MIXED)?names[objective]:"unknown";
+}
+
+class TuneCandidate{
+public:
+  int quantum;
+  double cost;
+  bool pruned;
+  int cycles;
+  int switches;
+};
+
+// Cycles between two checks of a run against the best cost
+int tuneCheckInterval = 32;
+// Quanta in the first, coarsest grid; fixed so that the quantum found
+// does not depend on the number of threads
+int tuneGrid = 16;
+
+// Nearest-rank p-th percentile of sorted values
+int percentileOf(const vector<int>& sorted, int p){
+  if(sorted.empty()){
+    return 0;
+  }
+  int rank = (p * (int)sorted.size() + 99) / 100;
+  return sorted[rank - 1];
+}
+
+// Nearest-rank 99th percentile
+double percentile99(vector<int> values){
+  sort(values.begin(), values.end());
+  return percentileOf(values, 99);
+}
+
+// Cost of a run so far. Processes still running or waiting count with
+// the wait they have now, those yet to arrive with none, so before the
+// end this is a lower bound of the final cost.
+double tuneCost(Simulation& sim, int objective, double penalty, int switches){
+  int n = (int)sim.arrivals.size();
+  sim.syncQueues();
+  if(n == 0){
+    return 0;
+  }
+  if(objective == TUNE_P99_TURNAROUND){
+    vector<int> turnaround;
+    for(int i=0; i < (int)sim.completed.size(); i++){
+      turnaround.push_back(sim.completed[i].wait + sim.completed[i].burst);
+    }
+    for(int i=0; i < (int)sim.cpu.size(); i++){
+      turnaround.push_back(sim.cpu[i].wait + sim.cpu[i].burst);
+    }
+    deque<Process> waiting = sim.waiting.contents(sim.waiting);
+    for(int i=0; i < (int)waiting.size(); i++){
+      turnaround.push_back(waiting[i].wait + waiting[i].burst);
+    }
+    for(int i=sim.nextArrival; i < n; i++){
+      turnaround.push_back(sim.arrivals[i].burst);
+    }
+    return percentile99(turnaround);
+  }
+  long waitTotal = 0;
+  for(int i=0; i < (int)sim.completed.size(); i++){
+    waitTotal += sim.completed[i].wait;
+  }
+  for(int i=0; i < (int)sim.cpu.size(); i++){
+    waitTotal += sim.cpu[i].wait;
+  }
+  deque<Process> waiting = sim.waiting.contents(sim.waiting);
+  for(int i=0; i < (int)waiting.size(); i++){
+    waitTotal += waiting[i].wait;
+  }
+  double cost = (double)waitTotal / n;
+  if(objective == TUNE_MIXED){
+    cost += penalty * switches / n;
+  }
+  return cost;
+}
+
+// Runs one quantum, giving up once its cost is sure to exceed the bound
+TuneCandidate evaluateQuantum(const vector<Process>& arrivals, bool aging, int quantum,
+                              int objective, double penalty, const atomic<double>& bound){
+  TuneCandidate candidate;
+  Process::setUseAging(aging);
+  Simulation sim(arrivals, POLICY_RR, quantum);
+  int running = -1;
+  candidate.quantum = quantum;
+  candidate.pruned = false;
+  candidate.switches = 0;
+  while(!sim.done()){
+    sim.step(NULL);
+    if(sim.runningPid() != -1 && sim.runningPid() != running){
+      running = sim.runningPid();
+      candidate.switches++;
+    }
+    if(sim.time % tuneCheckInterval == 0 && !sim.done()
+      && tuneCost(sim, objective, penalty, candidate.switches) > bound.load()){
+      candidate.pruned = true;
+      break;
+    }
+  }
+  candidate.cycles = sim.time;
+  candidate.cost = tuneCost(sim, objective, penalty, candidate.switches);
+  return candidate;
+}
+
+const report_column tuneColumns[] = {
+  {"quantum", "Quantum", 0}, {"cost", "Cost", 0}, {"cycles", "Cycles", 0}, {"switches", "Switches", 0},
+  {"cut_off", "Cut Off", 0}
+};
+
+// Lowers the shared best cost to cost, if that is lower
+void lowerBound(atomic<double>& bound, double cost){
+  double current = bound.load();
+  while(cost < current && !bound.compare_exchange_weak(current, cost)){
+  }
+}
+
+// Finds the best quantum for the workload, listing the candidates on os
+// unless it is NULL; a cut off candidate's cost is a lower bound. Ties
+// go to the smaller quantum.
+TuneCandidate tuneQuantum(const vector<Process>& arrivals, bool aging, int objective, double penalty, ostream* os){
+  int lo = 1;
+  int hi = 1;
+  for(int i=0; i < (int)arrivals.size(); i++){
+    // Beyond the longest burst every quantum schedules the same
+    hi = max(hi, arrivals[i].burst);
+  }
+  int threads = max(1, (int)thread::hardware_concurrency());
+  map<int, TuneCandidate> evaluated;
+  atomic<double> bound(numeric_limits<double>::infinity());
+  TuneCandidate best;
+  best.quantum = 0;
+  report out;
+  if(os != NULL){
+    string title = string("Tuning the RR quantum for ") + tuneObjectiveName(objective) + " over quanta "
+                   + to_string(lo) + "-" + to_string(hi) + ", " + to_string(threads) + " worker thread(s)...\n";
+    report_begin(&out, reportToStream, os, "tune", tuneColumns, 5, REPORT_TABS);
+    report_title(&out, title.c_str());
+  }
+  int step = max(1, (hi - lo + tuneGrid - 2) / (tuneGrid - 1));
+  vector<int> todo;
+  for(int q=lo; q < hi; q += step){
+    todo.push_back(q);
+  }
+  todo.push_back(hi);
+  while(!todo.empty()){
+    vector<TuneCandidate> results(todo.size());
+    atomic<int> next(0);
+    vector<thread> workers;
+    for(int t=0; t < min(threads, (int)todo.size()); t++){
+      workers.push_back(thread([&](){
+        int i;
+        while((i = next++) < (int)todo.size()){
+          results[i] = evaluateQuantum(arrivals, aging, todo[i], objective, penalty, bound);
+          if(!results[i].pruned){
+            lowerBound(bound, results[i].cost);
+          }
+        }
+      }));
+    }
+    for(int t=0; t < (int)workers.size(); t++){
+      workers[t].join();
+    }
+    for(int i=0; i < (int)results.size(); i++){
+      evaluated[results[i].quantum] = results[i];
+      if(os != NULL){
+        report_int(&out, results[i].quantum);
+        report_real(&out, results[i].cost, -1);
+        report_int(&out, results[i].cycles);
+        report_int(&out, results[i].switches);
+        report_text(&out, results[i].pruned?"yes":"no");
+      }
+    }
+    // Cut off quanta cost more than the best, so it is exact. The
+    // objective is not unimodal in the quantum, so the finer grid spans
+    // two coarse steps either side of the best rather than one.
+    for(map<int, TuneCandidate>::iterator it = evaluated.begin(); it != evaluated.end(); ++it){
+      if(!it->second.pruned && (best.quantum == 0 || it->second.cost < best.cost)){
+        best = it->second;
+      }
+    }
+    todo.clear();
+    if(step > 1){
+      int finer = max(1, step / 4);
+      for(int q=best.quantum - 2 * step + finer; q < best.quantum + 2 * step; q += finer){
+        if(q >= 1 && q <= hi && evaluated.find(q) == evaluated.end()){
+          todo.push_back(q);
+        }
+      }
+      step = finer;
+    }
+  }
+  if(os != NULL){
+    int pruned = 0;
+    for(map<int, TuneCandidate>::iterator it = evaluated.begin(); it != evaluated.end(); ++it){
+      pruned += it->second.pruned?1:0;
+    }
+    report_value_int(&out, "best_quantum", "Best quantum: ", best.quantum);
+    report_value_real(&out, "best_cost", "Best cost: ", best.cost, -1);
+    report_value_int(&out, "tried", "Quanta tried: ", (long long)evaluated.size());
+    report_value_int(&out, "cut_off", "Cut off early: ", pruned);
+    report_end(&out);
+    os->flush();
+  }
+  return best;
+}
+
+// Energy and latency of every policy under every governor, on cpus of
+// the given states and idle power capped at cap; throughput is in
+// processes per 1000 cycles and power is the mean over the run
+const report_column dvfsColumns[] = {
+  {"policy", "Algorithm", 0}, {"governor", "Governor", 0}, {"cycles", "Cycles", 0}, {"throughput", "Throughput", 0},
+  {"wait", "Wait", 0}, {"p99", "p99", 0}, {"energy", "Energy", 0}, {"power", "Power", 0}
+};
+
+void printDvfsComparison(const vector<Process>& arrivals, const vector<FrequencyState>& states, double idlePower,
+                         double cap, int timeQuantum, ostream& os){
+  report out;
+  report_begin(&out, reportToStream, &os, "dvfs", dvfsColumns, 8, REPORT_TABS);
+  report_title(&out, "Frequency scaling\n");
+  for(int policy=POLICY_FCFS; policy <= POLICY_RR; policy++){
+    for(int governor=GOVERNOR_PERFORMANCE; governor < GOVERNORS; governor++){
+      Dvfs dvfs(states, governor, idlePower, cap);
+      Simulation sim(arrivals, policy, policy == POLICY_RR?timeQuantum:0);
+      sim.dvfs = &dvfs;
+      while(!sim.done()){
+        sim.step(NULL);
+      }
+      RunColumns columns;
+      columns.add(sim.completed);
+      metrics_run sums = columns.compute(true)[0];
+      vector<int> turnaround = columns.turnaround;
+      sort(turnaround.begin(), turnaround.end());
+      report_text(&out, policyName(policy));
+      report_text(&out, governorNames[governor]);
+      report_int(&out, sim.time);
+      report_real(&out, 1000.0 * sim.completed.size() / max(1, sim.time), 2);
+      report_real(&out, sums.wait / max(1, sums.count), 2);
+      report_int(&out, percentileOf(turnaround, 99));
+      report_real(&out, dvfs.energy, 0);
+      report_real(&out, dvfs.energy / max(1LL, dvfs.cycles), 1);
+    }
+  }
+  report_end(&out);
+  os.flush();
+}
+
+}
+
+#endif
@@ -0,0 +1,159 @@
+/* estimate.h - queueing estimates of each policy
+ *
+ * Mean wait and turnaround predicted from the workload alone by fitting an
+ * M/G/1 queue: Poisson arrivals at the workload's mean rate, service times
+ * drawn from its bursts. FCFS is the Pollaczek-Khinchine mean, priority
+ * Cobham's formula per level, pre-emptive priority the pre-emptive resume
+ * one, SRTF Schrage and Miller's and RR processor sharing. Aging is not
+ * modelled, and a load of 1 or more gives infinite estimates.
+ */
+#ifndef ESTIMATE_H
+#define ESTIMATE_H
+
+#include <map>
+#include <limits>
+#include "report.h"
+#include "workload.h"
+
+namespace engine {
+
+// Queueing estimates
+// Processes, and their bursts summed and squared, of a priority level
+// or of one burst length
+class FitLevel{
+public:
+  long long count;
+  double bursts;
+  double squares;
+};
+
+class WorkloadFit{
+public:
+  int processes;
+  // Arrivals per cycle, mean burst and mean squared burst
+  double rate;
+  double meanBurst;
+  double burstSquare;
+  double load;
+  map<int, FitLevel> priorities;
+  map<int, FitLevel> bursts;
+};
+
+WorkloadFit fitWorkload(const vector<Process>& processes){
+  WorkloadFit fit;
+  int first = 0, last = 0;
+  double total = 0, squares = 0;
+  fit.processes = (int)processes.size();
+  for(int i=0; i < fit.processes; i++){
+    const Process& p = processes[i];
+    first = i?min(first, p.arrival):p.arrival;
+    last = i?max(last, p.arrival):p.arrival;
+    total += p.burst;
+    squares += (double)p.burst * p.burst;
+    FitLevel* levels[] = {&fit.priorities[p.priority], &fit.bursts[p.burst]};
+    for(int k=0; k < 2; k++){
+      levels[k]->count++;
+      levels[k]->bursts += p.burst;
+      levels[k]->squares += (double)p.burst * p.burst;
+    }
+  }
+  // n arrivals span n - 1 gaps; all at once is an infinite rate
+  fit.rate = last > first?(fit.processes - 1) / (double)(last - first):numeric_limits<double>::infinity();
+  fit.meanBurst = fit.processes?total / fit.processes:0;
+  fit.burstSquare = fit.processes?squares / fit.processes:0;
+  fit.load = fit.rate * fit.meanBurst;
+  return fit;
+}
+
+class QueueEstimate{
+public:
+  double wait;
+  double turnaround;
+};
+
+QueueEstimate estimateQueue(const WorkloadFit& fit, int policy){
+  QueueEstimate estimate;
+  double infinity = numeric_limits<double>::infinity();
+  double n = fit.processes;
+  estimate.wait = estimate.turnaround = infinity;
+  if(fit.processes == 0 || fit.load >= 1){
+    return estimate;
+  }
+  // Mean residual work an arrival finds in service
+  double residual = fit.rate * fit.burstSquare / 2;
+  double turnaround = 0;
+  if(policy == POLICY_FCFS){
+    turnaround = fit.meanBurst + residual / (1 - fit.load);
+  }else if(policy == POLICY_PRIORITY || policy == POLICY_PREEMPTIVE_PRIORITY){
+    // Levels in the order they run, lower priority values first
+    double above = 0, residualUpTo = 0;
+    for(map<int, FitLevel>::const_iterator level=fit.priorities.begin(); level != fit.priorities.end(); level++){
+      double share = level->second.count / n;
+      double mean = level->second.bursts / level->second.count;
+      double upTo = above + fit.rate * level->second.bursts / n;
+      residualUpTo += fit.rate * level->second.squares / n / 2;
+      if(policy == POLICY_PRIORITY){
+        turnaround += share * (mean + residual / ((1 - above) * (1 - upTo)));
+      }else{
+        turnaround += share * (mean / (1 - above) + residualUpTo / ((1 - above) * (1 - upTo)));
+      }
+      above = upTo;
+    }
+  }else if(policy == POLICY_SRTF){
+    // Load and residual of the processes no longer than each burst
+    double before = 0, shorter = 0, squaresUpTo = 0, served = 0, slowed = 0;
+    int previous = 0;
+    for(map<int, FitLevel>::const_iterator size=fit.bursts.begin(); size != fit.bursts.end(); size++){
+      double x = size->first;
+      double upTo = before + fit.rate * size->second.bursts / n;
+      shorter += size->second.count / n;
+      squaresUpTo += size->second.squares / n;
+      // Time in service, slowed by shorter arrivals; equal bursts do not
+      // preempt each other, so the wait is Cobham's per burst length
+      slowed += (x - previous) / (1 - before);
+      double waiting = fit.rate / 2 * (squaresUpTo + x * x * (1 - shorter)) / ((1 - before) * (1 - upTo));
+      served += size->second.count / n * (waiting + slowed);
+      before = upTo;
+      previous = size->first;
+    }
+    turnaround = served;
+  }else if(policy == POLICY_RR){
+    turnaround = fit.meanBurst / (1 - fit.load);
+  }
+  estimate.turnaround = turnaround;
+  estimate.wait = turnaround - fit.meanBurst;
+  return estimate;
+}
+
+// Error of an estimate relative to the simulated value, in percent
+double estimateError(double estimate, double simulated){
+  return simulated != 0?100 * (estimate - simulated) / simulated:numeric_limits<double>::quiet_NaN();
+}
+
+const report_column estimateColumns[] = {
+  {"policy", "Policy", 0}, {"wait", "Wait", 0}, {"turnaround", "Turnaround", 0}
+};
+
+// Estimates of every policy, as a table or as REPORT_FORMAT asks
+void printEstimates(const vector<Process>& processes, ostream& os){
+  WorkloadFit fit = fitWorkload(processes);
+  report out;
+  report_begin(&out, reportToStream, &os, "estimates", estimateColumns, 3, REPORT_TABS);
+  report_title(&out, "Queueing estimates\n");
+  for(int policy=POLICY_FCFS; policy <= POLICY_RR; policy++){
+    QueueEstimate estimate = estimateQueue(fit, policy);
+    report_text(&out, policyName(policy));
+    report_real(&out, estimate.wait, 2);
+    report_real(&out, estimate.turnaround, 2);
+  }
+  report_value_int(&out, "processes", "Processes: ", fit.processes);
+  report_value_real(&out, "arrival_rate", "Arrival Rate: ", fit.rate, -1);
+  report_value_real(&out, "mean_burst", "Mean Burst: ", fit.meanBurst, -1);
+  report_value_real(&out, "load", "Load: ", fit.load, -1);
+  report_end(&out);
+  os.flush();
+}
+
+}
+
+#endif
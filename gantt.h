@@ -0,0 +1,281 @@
+/* gantt.h - run-length compressed, zoomable Gantt chart renderer
+ *
+ * Shared by the C and C++ front-ends. Slices are fed in time order with
+ * gantt_add(); consecutive slices of the same process are merged, gaps are
+ * shown as idle (IS) and time is bucketed into columns of a chart that fits
+ * the target width. A column shared by several slices shows the process that
+ * ran most of it, or '*' when none did. Output is written band by band, so
+ * only one band of the chart is ever held in memory.
+ *
+ * Environment:
+ *  GANTT_WIDTH - target width in columns (default 64)
+ *  GANTT_SCALE - time units per column; zooms the chart and wraps it into
+ *                bands of GANTT_WIDTH columns instead of fitting it
+ *  GANTT_SVG   - file the chart is also written to as SVG
+ *  TRACE_EVENTS - file the runs are also written to as Chrome trace-event
+ *                JSON, one time unit to a microsecond, for trace viewers
+ */
+#ifndef GANTT_H
+#define GANTT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GANTT_IDLE -1
+#define GANTT_MIXED -2
+#define GANTT_WIDTH 64
+#define GANTT_MAX_WIDTH 512
+#define GANTT_MAX_ZOOM 8
+#define GANTT_SVG_COLUMN 8
+#define GANTT_SVG_HEIGHT 32
+
+struct gantt{
+    FILE *out;
+    FILE *svg;
+    FILE *trace;
+    long long num, den;
+    int width;
+    const char *(*label)(int id, void *ctx);
+    void *ctx;
+    /*
+        out - stream the chart is written to
+        svg - stream the SVG copy is written to, or NULL
+        trace - stream the trace events are written to, or NULL
+        num, den - a time t falls in column t * num / den
+        width - columns per band
+        label - names the process of a slice, ctx is handed to it
+    */
+    int have_run, run_id;
+    long run_start, run_end;
+    /*
+        run - slices merged so far that have not been bucketed yet
+    */
+    long long col, col_best, col_fill;
+    int col_id, col_runs;
+    long col_time;
+    /*
+        col - absolute column being filled
+        col_best, col_id - process with the largest share of it
+        col_fill - share of the column covered so far
+        col_runs - runs that touched the column
+        col_time - start of that process' run, printed if the column starts a segment
+    */
+    int used, seg_start, seg_id, times_end;
+    char top[GANTT_MAX_WIDTH + 2];
+    char mid[GANTT_MAX_WIDTH + 2];
+    char times[GANTT_MAX_WIDTH + 24];
+    /*
+        used - columns of the current band already filled
+        seg_start, seg_id - column where the open segment starts and its process
+        times_end - first free position of the time row
+    */
+};
+
+static const char *gantt_default_label(int id, void *ctx){
+    static char name[16];
+    (void)ctx;
+    if(id == GANTT_IDLE)
+        return "IS";
+    if(id == GANTT_MIXED)
+        return "*";
+    sprintf(name, "P%d", id);
+    return name;
+}
+
+static const char *gantt_name(struct gantt *g, int id){
+    if(id == GANTT_IDLE || id == GANTT_MIXED)
+        return gantt_default_label(id, NULL);
+    return g->label(id, g->ctx);
+}
+
+static void gantt_time(struct gantt *g, int pos, long time, int force){
+    char num[24];
+    int len = sprintf(num, "%ld", time);
+    if(pos < g->times_end && pos != 0){
+        if(!force)
+            return;/*no room, the previous number is still being printed*/
+        pos = g->times_end;
+    }
+    memset(g->times + g->times_end, ' ', pos - g->times_end > 0 ? pos - g->times_end : 0);
+    memcpy(g->times + pos, num, len);
+    g->times_end = pos + len + 1;
+    g->times[pos + len] = ' ';
+}
+
+static void gantt_close_segment(struct gantt *g){
+    const char *name;
+    int room, len;
+    if(g->used == 0)
+        return;
+    room = g->used - g->seg_start - 1;
+    name = gantt_name(g, g->seg_id);
+    len = (int)strlen(name);
+    if(len <= room)
+        memcpy(g->mid + g->seg_start + 1 + (room - len) / 2, name, len);
+    else if(room > 0)
+        memset(g->mid + g->seg_start + 1, '.', room);/*a sliver too narrow for its name*/
+}
+
+static void gantt_flush_band(struct gantt *g, long time){
+    gantt_close_segment(g);
+    g->top[g->used] = '+';
+    g->mid[g->used] = '|';
+    g->top[g->used + 1] = g->mid[g->used + 1] = '\0';
+    gantt_time(g, g->used, time, 1);
+    g->times[g->times_end - 1] = '\0';
+    fprintf(g->out, "%s\n%s\n%s\n%s\n\n", g->top, g->mid, g->top, g->times);
+    g->used = 0;
+    g->times_end = 0;
+}
+
+static void gantt_cell(struct gantt *g, int id, long time, long col_start){
+    if(g->used == g->width)
+        gantt_flush_band(g, col_start);
+    if(g->used == 0 || id != g->seg_id){/*a new segment starts in this column*/
+        gantt_close_segment(g);
+        g->seg_start = g->used;
+        g->seg_id = id;
+        g->top[g->used] = '+';
+        g->mid[g->used] = '|';
+        gantt_time(g, g->used, g->used == 0 && time < col_start ? col_start : time, 0);
+    }
+    else{
+        g->top[g->used] = '-';
+        g->mid[g->used] = ' ';
+    }
+    g->used++;
+}
+
+static void gantt_close_column(struct gantt *g){
+    int id = g->col_id;
+    if(g->col_runs > 1 && g->col_best * 2 < g->col_fill)
+        id = GANTT_MIXED;
+    gantt_cell(g, id, g->col_time, (long)((g->col * g->den + g->num - 1) / g->num));
+    g->col++;
+    g->col_best = g->col_fill = 0;
+    g->col_runs = 0;
+}
+
+static void gantt_svg_run(struct gantt *g, int id, long start, long end){
+    double x = (double)start * g->num / g->den * GANTT_SVG_COLUMN;
+    double w = (double)(end - start) * g->num / g->den * GANTT_SVG_COLUMN;
+    const char *name = gantt_name(g, id);
+    fprintf(g->svg, "<rect x=\"%.2f\" y=\"0\" width=\"%.2f\" height=\"%d\" fill=\"%s\" stroke=\"#333\">"
+            "<title>%s %ld-%ld</title></rect>\n", x, w, GANTT_SVG_HEIGHT,
+            id == GANTT_IDLE ? "#eee" : id % 2 ? "#9cf" : "#fc9", name, start, end);
+    if(w >= 8.0 * strlen(name))
+        fprintf(g->svg, "<text x=\"%.2f\" y=\"%d\" text-anchor=\"middle\">%s</text>\n", x + w / 2, GANTT_SVG_HEIGHT / 2 + 5, name);
+    fprintf(g->svg, "<text x=\"%.2f\" y=\"%d\" font-size=\"10\">%ld</text>\n", x, GANTT_SVG_HEIGHT + 12, start);
+}
+
+/* one slice per merged run, written as it is bucketed */
+static void gantt_trace_run(struct gantt *g, int id, long start, long end){
+    const char *name = gantt_name(g, id);
+    fprintf(g->trace, ",\n{\"name\":\"");
+    for(; *name != '\0'; name++){
+        if(*name == '"' || *name == '\\')
+            fputc('\\', g->trace);
+        fputc(*name, g->trace);
+    }
+    fprintf(g->trace, "\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":%ld,\"dur\":%ld}", start, end - start);
+}
+
+static void gantt_run(struct gantt *g, int id, long start, long end){
+    long long xs = start * g->num, xe = end * g->num, piece, c;
+    if(g->svg != NULL)
+        gantt_svg_run(g, id, start, end);
+    if(g->trace != NULL && id != GANTT_IDLE)
+        gantt_trace_run(g, id, start, end);
+    while(xs < xe){/*spread the run over the columns it covers*/
+        c = xs / g->den;
+        while(g->col < c)
+            gantt_close_column(g);
+        piece = ((c + 1) * g->den < xe ? (c + 1) * g->den : xe) - xs;
+        if(piece > g->col_best){
+            g->col_best = piece;
+            g->col_id = id;
+            g->col_time = start;
+        }
+        g->col_fill += piece;
+        g->col_runs++;
+        xs += piece;
+    }
+}
+
+static void gantt_begin(struct gantt *g, FILE *out, long total){
+    const char *env;
+    long scale = 0;
+    memset(g, 0, sizeof(*g));
+    g->out = out;
+    g->label = gantt_default_label;
+    g->width = GANTT_WIDTH;
+    if((env = getenv("GANTT_WIDTH")) != NULL && atoi(env) > 1)
+        g->width = atoi(env) < GANTT_MAX_WIDTH ? atoi(env) : GANTT_MAX_WIDTH;
+    if((env = getenv("GANTT_SCALE")) != NULL)
+        scale = atol(env);
+    if(scale > 0){/*zoomed: fixed scale, the chart wraps into bands*/
+        g->num = 1;
+        g->den = scale;
+    }
+    else if(total > 0 && total * GANTT_MAX_ZOOM > g->width){/*fit the whole chart in one band*/
+        g->num = g->width;
+        g->den = total;
+    }
+    else{
+        g->num = GANTT_MAX_ZOOM;
+        g->den = 1;
+    }
+    if((env = getenv("GANTT_SVG")) != NULL && (g->svg = fopen(env, "w")) != NULL){
+        fprintf(g->svg, "<svg xmlns=\"http://www.w3.org/2000/svg\" font-family=\"monospace\" font-size=\"12\"");
+        if(total > 0)
+            fprintf(g->svg, " width=\"%.0f\"", (double)total * g->num / g->den * GANTT_SVG_COLUMN + 40);
+        fprintf(g->svg, " height=\"%d\">\n<g transform=\"translate(10,4)\">\n", GANTT_SVG_HEIGHT + 24);
+    }
+    if((env = getenv("TRACE_EVENTS")) != NULL && (g->trace = fopen(env, "w")) != NULL)/*every event after the first starts with a comma*/
+        fprintf(g->trace, "{\"traceEvents\":[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}}");
+}
+
+static void gantt_add(struct gantt *g, int id, long start, long end){
+    long prev = g->have_run ? g->run_end : 0;
+    if(start < prev)
+        start = prev;
+    if(end <= start)
+        return;
+    if(start > prev)/*nothing ran in between*/
+        gantt_add(g, GANTT_IDLE, prev, start);
+    if(g->have_run && id == g->run_id){/*same process again, extend the run*/
+        g->run_end = end;
+        return;
+    }
+    if(g->have_run)
+        gantt_run(g, g->run_id, g->run_start, g->run_end);
+    g->have_run = 1;
+    g->run_id = id;
+    g->run_start = start;
+    g->run_end = end;
+}
+
+static void gantt_end(struct gantt *g){
+    if(g->have_run){
+        gantt_run(g, g->run_id, g->run_start, g->run_end);
+        if(g->col_fill > 0)
+            gantt_close_column(g);
+        gantt_flush_band(g, g->run_end);
+    }
+    if(g->svg != NULL){
+        if(g->have_run)
+            fprintf(g->svg, "<text x=\"%.2f\" y=\"%d\" font-size=\"10\">%ld</text>\n",
+                    (double)g->run_end * g->num / g->den * GANTT_SVG_COLUMN, GANTT_SVG_HEIGHT + 12, g->run_end);
+        fprintf(g->svg, "</g>\n</svg>\n");
+        fclose(g->svg);
+        g->svg = NULL;
+    }
+    if(g->trace != NULL){
+        fprintf(g->trace, "\n]}\n");
+        fclose(g->trace);
+        g->trace = NULL;
+    }
+}
+
+#endif
@@ -0,0 +1,419 @@
+/* Differential harness
+* Runs the same random workloads through every implementation of
+* each scheduling algorithm in this repository and reports where
+* they disagree on a process' waiting or turnaround time, along
+* with the mean time each implementation takes per workload.
+*
+* Build: g++ -O2 -o harness harness.cpp
+* Usage: harness [workloads] [processes] [seed] [ties]
+*
+* OS.cpp's engine comes from engine.h. Every other program is
+* compiled into its own namespace, so their globals and main
+* functions do not collide and only their scheduling functions
+* are called; the menus never run. The headers they include are
+* included first, so they stay out of those namespaces.
+* OS.cpp is the reference of every group it implements.
+* Values are drawn without repeats unless ties is 1, as the
+* programs break ties differently; all-at-zero arrivals are still
+* a tie, which OS.cpp and FCFS.cpp break in heap order.
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <queue>
+#include <chrono>
+#include <random>
+#include "gantt.h"
+#include "engine.h"
+
+#ifdef _WIN32
+#include <conio.h>
+#else
+static int getch(){ return getchar(); }
+#endif
+
+namespace fcfs {
+#include "FCFS.cpp"
+}
+namespace port {
+#include "PORT.c"
+}
+namespace fin {
+#include "fin.c"
+}
+namespace final_os {
+#include "FINAL OS.c"
+}
+
+using namespace std;
+
+// FINAL OS.c holds at most 10 processes
+const int maxProcesses = 10;
+
+class Job{
+public:
+  int pid;
+  int arrival;
+  int burst;
+  int priority;
+};
+
+class Workload{
+public:
+  unsigned seed;
+  int quantum;
+  vector<Job> jobs;
+};
+
+// Waiting and turnaround time of every process, indexed by pid
+class Times{
+public:
+  vector<int> wait;
+  vector<int> turnaround;
+};
+
+enum Group{
+  GROUP_FCFS,
+  GROUP_SJF,
+  GROUP_SRTF,
+  GROUP_PRIORITY,
+  GROUP_PREEMPTIVE_PRIORITY,
+  GROUP_RR,
+  GROUP_COUNT
+};
+
+const char* groupNames[GROUP_COUNT] = {"FCFS", "SJF", "SRTF", "Priority", "Preemptive Priority", "RR"};
+
+typedef void (*Runner)(const Workload&, Times&);
+
+class Implementation{
+public:
+  const char* name;
+  int group;
+  Runner run;
+};
+
+// What one implementation did while the workloads ran
+class Tally{
+public:
+  int runs;
+  int mismatched;
+  int maxDiff;
+  long firstSeed;
+  double nanoseconds;
+};
+
+// Without ties the bursts, priorities and staggered arrivals are drawn
+// without repeats, so any disagreement is not just a tie broken another way
+Workload makeWorkload(unsigned seed, int n, bool allAtZero, bool ties){
+  mt19937 rng(seed);
+  vector<int> arrivals, bursts, priorities;
+  for(int i=0; i < 16; i++){
+    arrivals.push_back(i);
+  }
+  for(int i=1; i <= maxProcesses; i++){
+    bursts.push_back(i);
+    priorities.push_back(i);
+  }
+  shuffle(arrivals.begin(), arrivals.end(), rng);
+  shuffle(bursts.begin(), bursts.end(), rng);
+  shuffle(priorities.begin(), priorities.end(), rng);
+  Workload w;
+  w.seed = seed;
+  w.quantum = 1 + rng() % 4;
+  for(int i=0; i < n; i++){
+    Job j;
+    j.pid = i+1;
+    j.arrival = allAtZero?0:ties?rng() % 16:arrivals[i];
+    j.burst = ties?1 + rng() % 10:bursts[i];
+    j.priority = ties?1 + rng() % 5:priorities[i];
+    w.jobs.push_back(j);
+  }
+  return w;
+}
+
+void resize(Times& t, int n){
+  t.wait.assign(n+1, -1);
+  t.turnaround.assign(n+1, -1);
+}
+
+// OS.cpp
+
+void runOS(const Workload& w, Times& t, int policy){
+  priority_queue<engine::Process> processes;
+  for(size_t i=0; i < w.jobs.size(); i++){
+    processes.push(engine::Process(w.jobs[i].pid, w.jobs[i].arrival, w.jobs[i].burst, w.jobs[i].priority));
+  }
+  engine::Process::setUseAging(false);
+  engine::Simulation sim(processes, policy, policy == engine::POLICY_RR?w.quantum:0);
+  while(!sim.done()){
+    sim.step(NULL);
+  }
+  resize(t, w.jobs.size());
+  for(size_t i=0; i < sim.completed.size(); i++){
+    t.wait[sim.completed[i].pid] = sim.completed[i].wait;
+    t.turnaround[sim.completed[i].pid] = sim.completed[i].wait + sim.completed[i].completedCycles;
+  }
+}
+
+void runOSFCFS(const Workload& w, Times& t){ runOS(w, t, engine::POLICY_FCFS); }
+void runOSSRTF(const Workload& w, Times& t){ runOS(w, t, engine::POLICY_SRTF); }
+void runOSPriority(const Workload& w, Times& t){ runOS(w, t, engine::POLICY_PRIORITY); }
+void runOSPreemptivePriority(const Workload& w, Times& t){ runOS(w, t, engine::POLICY_PREEMPTIVE_PRIORITY); }
+void runOSRR(const Workload& w, Times& t){ runOS(w, t, engine::POLICY_RR); }
+
+// FCFS.cpp
+
+void runFCFSCpp(const Workload& w, Times& t){
+  priority_queue<fcfs::process> ready_queue, completion_queue;
+  queue<fcfs::process> gantt;
+  for(size_t i=0; i < w.jobs.size(); i++){
+    fcfs::process p;
+    p.p_no = w.jobs[i].pid;
+    p.AT = w.jobs[i].arrival;
+    p.BT = w.jobs[i].burst;
+    p.priority = w.jobs[i].priority;
+    p.P_set();
+    ready_queue.push(p);
+  }
+  completion_queue = fcfs::FCFS_run(ready_queue, &gantt);
+  resize(t, w.jobs.size());
+  while(!completion_queue.empty()){
+    t.wait[completion_queue.top().p_no] = completion_queue.top().WT;
+    t.turnaround[completion_queue.top().p_no] = completion_queue.top().TAT;
+    completion_queue.pop();
+  }
+}
+
+// FINAL OS.c, processes are named after their pid
+
+void fillFinal(const Workload& w, final_os::processes P[]){
+  for(size_t i=0; i < w.jobs.size(); i++){
+    snprintf(P[i].name, sizeof(P[i].name), "P%d", w.jobs[i].pid);
+    P[i].bt = w.jobs[i].burst;
+    P[i].at = w.jobs[i].arrival;
+    P[i].prt = w.jobs[i].priority;
+    P[i].wt = P[i].ta = P[i].flag = 0;
+  }
+}
+
+void readFinal(const Workload& w, final_os::processes temp[], Times& t){
+  resize(t, w.jobs.size());
+  for(size_t i=0; i < w.jobs.size(); i++){
+    int pid = atoi(temp[i].name + 1);
+    t.wait[pid] = temp[i].wt;
+    t.turnaround[pid] = temp[i].ta;
+  }
+}
+
+void runFinalFCFS(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::FCFS_run(P, w.jobs.size(), temp);
+  readFinal(w, temp, t);
+}
+
+void runFinalSJF(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::SJF_NP_run(P, w.jobs.size(), temp);
+  readFinal(w, temp, t);
+}
+
+void runFinalSRTF(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::SJF_P_run(P, w.jobs.size(), temp, NULL);
+  readFinal(w, temp, t);
+}
+
+void runFinalPriority(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::PRT_NP_run(P, w.jobs.size(), temp);
+  readFinal(w, temp, t);
+}
+
+void runFinalPreemptivePriority(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::PRT_P_run(P, w.jobs.size(), temp, NULL);
+  readFinal(w, temp, t);
+}
+
+void runFinalRR(const Workload& w, Times& t){
+  final_os::processes P[maxProcesses], temp[maxProcesses];
+  fillFinal(w, P);
+  final_os::RR_run(P, w.jobs.size(), w.quantum, temp, NULL);
+  readFinal(w, temp, t);
+}
+
+// PORT.c and fin.c share their scheduling code but are separate copies,
+// so both are run. Outside round robin a process runs in one slice, so it
+// waits from its arrival to the start of the slice and turns around at
+// its end. Round robin leaves the times in the process copies.
+
+#define PORT_RUNNERS(ns, Name)                                                        \
+  ns::processes* build##Name(const Workload& w, ns::process_arena* arena){            \
+    ns::processes *list = NULL, *last = NULL, *node;                                  \
+    ns::arena_reset(arena);                                                           \
+    for(size_t i=0; i < w.jobs.size(); i++){                                          \
+      node = ns::enter_processes(arena, w.jobs[i].pid, w.jobs[i].burst, w.jobs[i].priority, w.jobs[i].arrival); \
+      if(last == NULL){                                                               \
+        list = node;                                                                  \
+      }else{                                                                          \
+        last->prox = node;                                                            \
+      }                                                                               \
+      last = node;                                                                    \
+    }                                                                                 \
+    return list;                                                                      \
+  }                                                                                   \
+  void run##Name(const Workload& w, Times& t, int algorithm){                         \
+    ns::process_arena list = {NULL, NULL}, work = {NULL, NULL};                       \
+    ns::schedule sched = {NULL, 0, 0};                                                \
+    ns::processes* loc = build##Name(w, &list);                                       \
+    resize(t, w.jobs.size());                                                         \
+    if(algorithm == GROUP_RR){                                                        \
+      for(loc = ns::robbin_round(loc, &work, w.quantum, &sched); loc != NULL; loc = loc->prox){ \
+        t.wait[loc->id] = loc->esp;                                                   \
+        t.turnaround[loc->id] = loc->fim - loc->arr;                                  \
+      }                                                                               \
+    }else{                                                                            \
+      if(algorithm == GROUP_FCFS){                                                    \
+        ns::fcfs(loc, &sched);                                                        \
+      }else if(algorithm == GROUP_SJF){                                               \
+        ns::sjf(loc, &work, &sched);                                                  \
+      }else{                                                                          \
+        ns::scheduling_priority(loc, &work, &sched);                                  \
+      }                                                                               \
+      for(int i=0; i < sched.n; i++){                                                 \
+        t.wait[sched.slices[i].id] = sched.slices[i].start - sched.slices[i].arr;     \
+        t.turnaround[sched.slices[i].id] = sched.slices[i].end - sched.slices[i].arr; \
+      }                                                                               \
+    }                                                                                 \
+    free(sched.slices);                                                               \
+    ns::arena_release(&list);                                                         \
+    ns::arena_release(&work);                                                         \
+  }                                                                                   \
+  void run##Name##FCFS(const Workload& w, Times& t){ run##Name(w, t, GROUP_FCFS); }   \
+  void run##Name##SJF(const Workload& w, Times& t){ run##Name(w, t, GROUP_SJF); }     \
+  void run##Name##Priority(const Workload& w, Times& t){ run##Name(w, t, GROUP_PRIORITY); } \
+  void run##Name##RR(const Workload& w, Times& t){ run##Name(w, t, GROUP_RR); }
+
+PORT_RUNNERS(port, Port)
+PORT_RUNNERS(fin, Fin)
+
+// The first implementation of a group is its reference
+Implementation implementations[] = {
+  {"OS.cpp",       GROUP_FCFS, runOSFCFS},
+  {"FCFS.cpp",     GROUP_FCFS, runFCFSCpp},
+  {"FINAL OS.c",   GROUP_FCFS, runFinalFCFS},
+  {"PORT.c",       GROUP_FCFS, runPortFCFS},
+  {"fin.c",        GROUP_FCFS, runFinFCFS},
+  {"FINAL OS.c",   GROUP_SJF, runFinalSJF},
+  {"PORT.c",       GROUP_SJF, runPortSJF},
+  {"fin.c",        GROUP_SJF, runFinSJF},
+  {"OS.cpp",       GROUP_SRTF, runOSSRTF},
+  {"FINAL OS.c",   GROUP_SRTF, runFinalSRTF},
+  {"OS.cpp",       GROUP_PRIORITY, runOSPriority},
+  {"FINAL OS.c",   GROUP_PRIORITY, runFinalPriority},
+  {"PORT.c",       GROUP_PRIORITY, runPortPriority},
+  {"fin.c",        GROUP_PRIORITY, runFinPriority},
+  {"OS.cpp",       GROUP_PREEMPTIVE_PRIORITY, runOSPreemptivePriority},
+  {"FINAL OS.c",   GROUP_PREEMPTIVE_PRIORITY, runFinalPreemptivePriority},
+  {"OS.cpp",       GROUP_RR, runOSRR},
+  {"FINAL OS.c",   GROUP_RR, runFinalRR},
+  {"PORT.c",       GROUP_RR, runPortRR},
+  {"fin.c",        GROUP_RR, runFinRR},
+};
+const int implementationCount = sizeof(implementations) / sizeof(implementations[0]);
+Tally tallies[implementationCount];
+
+// Largest per-process difference between two results, 0 if they agree
+int difference(const Times& a, const Times& b){
+  int diff = 0;
+  for(size_t pid=1; pid < a.wait.size(); pid++){
+    diff = max(diff, abs(a.wait[pid] - b.wait[pid]));
+    diff = max(diff, abs(a.turnaround[pid] - b.turnaround[pid]));
+  }
+  return diff;
+}
+
+void printReport(ostream& os, int workloads, int n, unsigned seed, bool ties){
+  os << "Differential run: " << workloads << " workloads of " << n << " processes, seed " << seed << (ties?", with ties":"") << endl;
+  for(int g=0; g < GROUP_COUNT; g++){
+    os << endl << groupNames[g] << endl;
+    os << "Implementation\tRuns\tMismatched\tMax diff\tFirst seed\tus/run" << endl;
+    bool reference = true;
+    for(int i=0; i < implementationCount; i++){
+      Implementation& impl = implementations[i];
+      Tally& tally = tallies[i];
+      if(impl.group != g){
+        continue;
+      }
+      os << impl.name << "\t" << tally.runs << "\t";
+      if(reference){
+        os << "reference\t-\t-";
+        reference = false;
+      }else{
+        os << tally.mismatched << "\t" << tally.maxDiff << "\t";
+        if(tally.firstSeed < 0){
+          os << "-";
+        }else{
+          os << tally.firstSeed;
+        }
+      }
+      os << "\t" << (tally.runs?tally.nanoseconds / tally.runs / 1000.0:0.0) << endl;
+    }
+  }
+}
+
+int main(int argc, char* argv[]){
+  int workloads = argc > 1?atoi(argv[1]):1000;
+  int n = argc > 2?atoi(argv[2]):maxProcesses;
+  unsigned seed = argc > 3?strtoul(argv[3], NULL, 10):1;
+  bool ties = argc > 4 && atoi(argv[4]) == 1;
+  if(n < 1 || n > maxProcesses){
+    cout << "Processes must be between 1 and " << maxProcesses << endl;
+    return 1;
+  }
+  for(int i=0; i < implementationCount; i++){
+    tallies[i].runs = 0;
+    tallies[i].mismatched = 0;
+    tallies[i].maxDiff = 0;
+    tallies[i].firstSeed = -1;
+    tallies[i].nanoseconds = 0;
+  }
+  bool disagreed = false;
+  for(int k=0; k < workloads; k++){
+    // Every other workload arrives all at once, as the programs first assumed
+    Workload w = makeWorkload(seed + k, n, k % 2 == 0, ties);
+    Times reference[GROUP_COUNT];
+    bool haveReference[GROUP_COUNT] = {false};
+    for(int i=0; i < implementationCount; i++){
+      Implementation& impl = implementations[i];
+      Tally& tally = tallies[i];
+      Times t;
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      impl.run(w, t);
+      tally.nanoseconds += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+      tally.runs++;
+      if(!haveReference[impl.group]){
+        reference[impl.group] = t;
+        haveReference[impl.group] = true;
+        continue;
+      }
+      int diff = difference(reference[impl.group], t);
+      if(diff > 0){
+        tally.mismatched++;
+        tally.maxDiff = max(tally.maxDiff, diff);
+        if(tally.firstSeed < 0){
+          tally.firstSeed = w.seed;
+        }
+        disagreed = true;
+      }
+    }
+  }
+  printReport(cout, workloads, n, seed, ties);
+  return disagreed?2:0;
+}
@@ -0,0 +1,195 @@
+/* metrics.h - per-process metrics of many runs in one pass
+ *
+ * Shared by the C and C++ front-ends. The finished processes of any number
+ * of runs are laid out column by column: arrival, first cycle on the CPU,
+ * completion and burst, run after run, with run r holding processes
+ * offsets[r] to offsets[r+1] - 1. metrics_compute() walks the columns once
+ * and derives each process' wait, turnaround, response and slowdown, plus
+ * the sums of every run, eight processes at a time with AVX2, four with
+ * SSE2 and one at a time otherwise. Build with -mavx2 (or -march=native)
+ * for the AVX2 loop and with -DNO_SIMD for the plain one.
+ *
+ *  wait       = completion - arrival - burst
+ *  turnaround = completion - arrival
+ *  response   = first run - arrival
+ *  slowdown   = turnaround / burst, a burst below 1 counting as 1
+ */
+#ifndef METRICS_H
+#define METRICS_H
+
+#if !defined(NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define METRICS_AVX2
+#elif !defined(NO_SIMD) && (defined(__SSE2__) || defined(_M_X64))
+#include <emmintrin.h>
+#define METRICS_SSE2
+#endif
+
+struct metrics_columns{
+    const int *arrival;
+    const int *first_run;
+    const int *completion;
+    const int *burst;
+    /*
+        arrival, first_run, completion, burst - one value per process
+    */
+    int *wait;
+    int *turnaround;
+    int *response;
+    float *slowdown;
+    /*
+        wait, turnaround, response, slowdown - filled per process unless NULL
+    */
+};
+
+struct metrics_run{
+    int count;
+    double wait;
+    double turnaround;
+    double response;
+    double slowdown;
+    int max_turnaround;
+    /*
+        count - processes in the run
+        wait, turnaround, response, slowdown - sums over them
+        max_turnaround - longest turnaround, 0 for an empty run
+    */
+};
+
+#if defined(METRICS_AVX2)
+static double metrics_sum4(__m256d v){
+    __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+}
+
+/* adds the eight ints of v to the sum held in lo and hi */
+static void metrics_add8(__m256d *lo, __m256d *hi, __m256i v){
+    *lo = _mm256_add_pd(*lo, _mm256_cvtepi32_pd(_mm256_castsi256_si128(v)));
+    *hi = _mm256_add_pd(*hi, _mm256_cvtepi32_pd(_mm256_extracti128_si256(v, 1)));
+}
+#elif defined(METRICS_SSE2)
+static double metrics_sum2(__m128d v){
+    return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+}
+
+/* adds the four ints of v to the sum held in lo and hi */
+static void metrics_add4(__m128d *lo, __m128d *hi, __m128i v){
+    *lo = _mm_add_pd(*lo, _mm_cvtepi32_pd(v));
+    *hi = _mm_add_pd(*hi, _mm_cvtepi32_pd(_mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2))));
+}
+
+/* SSE2 has no signed 32 bit max */
+static __m128i metrics_max4(__m128i a, __m128i b){
+    __m128i greater = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(greater, a), _mm_andnot_si128(greater, b));
+}
+#endif
+
+/* processes lo to hi - 1 of the columns, summed into run */
+static void metrics_range(const struct metrics_columns *c, int lo, int hi, struct metrics_run *run){
+    int i = lo, longest = 0, turnaround, burst;
+    double wait = 0, total = 0, response = 0, slowdown = 0;
+    float ratio;
+#if defined(METRICS_AVX2)
+    __m256d wait_lo = _mm256_setzero_pd(), wait_hi = wait_lo, total_lo = wait_lo, total_hi = wait_lo;
+    __m256d response_lo = wait_lo, response_hi = wait_lo, slowdown_lo = wait_lo, slowdown_hi = wait_lo;
+    __m256i one = _mm256_set1_epi32(1), most = _mm256_setzero_si256();
+    int lanes[8], k;
+    for(; i + 8 <= hi; i += 8){
+        __m256i a = _mm256_loadu_si256((const __m256i *)(c->arrival + i));
+        __m256i t = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(c->completion + i)), a);
+        __m256i b = _mm256_loadu_si256((const __m256i *)(c->burst + i));
+        __m256i w = _mm256_sub_epi32(t, b);
+        __m256i r = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(c->first_run + i)), a);
+        __m256 s = _mm256_div_ps(_mm256_cvtepi32_ps(t), _mm256_cvtepi32_ps(_mm256_max_epi32(b, one)));
+        if(c->wait != NULL)
+            _mm256_storeu_si256((__m256i *)(c->wait + i), w);
+        if(c->turnaround != NULL)
+            _mm256_storeu_si256((__m256i *)(c->turnaround + i), t);
+        if(c->response != NULL)
+            _mm256_storeu_si256((__m256i *)(c->response + i), r);
+        if(c->slowdown != NULL)
+            _mm256_storeu_ps(c->slowdown + i, s);
+        metrics_add8(&wait_lo, &wait_hi, w);
+        metrics_add8(&total_lo, &total_hi, t);
+        metrics_add8(&response_lo, &response_hi, r);
+        slowdown_lo = _mm256_add_pd(slowdown_lo, _mm256_cvtps_pd(_mm256_castps256_ps128(s)));
+        slowdown_hi = _mm256_add_pd(slowdown_hi, _mm256_cvtps_pd(_mm256_extractf128_ps(s, 1)));
+        most = _mm256_max_epi32(most, t);
+    }
+    wait = metrics_sum4(_mm256_add_pd(wait_lo, wait_hi));
+    total = metrics_sum4(_mm256_add_pd(total_lo, total_hi));
+    response = metrics_sum4(_mm256_add_pd(response_lo, response_hi));
+    slowdown = metrics_sum4(_mm256_add_pd(slowdown_lo, slowdown_hi));
+    _mm256_storeu_si256((__m256i *)lanes, most);
+    for(k=0; k<8; k++)
+        longest = lanes[k] > longest ? lanes[k] : longest;
+#elif defined(METRICS_SSE2)
+    __m128d wait_lo = _mm_setzero_pd(), wait_hi = wait_lo, total_lo = wait_lo, total_hi = wait_lo;
+    __m128d response_lo = wait_lo, response_hi = wait_lo, slowdown_lo = wait_lo, slowdown_hi = wait_lo;
+    __m128i one = _mm_set1_epi32(1), most = _mm_setzero_si128();
+    int lanes[4], k;
+    for(; i + 4 <= hi; i += 4){
+        __m128i a = _mm_loadu_si128((const __m128i *)(c->arrival + i));
+        __m128i t = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(c->completion + i)), a);
+        __m128i b = _mm_loadu_si128((const __m128i *)(c->burst + i));
+        __m128i w = _mm_sub_epi32(t, b);
+        __m128i r = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(c->first_run + i)), a);
+        __m128 s = _mm_div_ps(_mm_cvtepi32_ps(t), _mm_cvtepi32_ps(metrics_max4(b, one)));
+        if(c->wait != NULL)
+            _mm_storeu_si128((__m128i *)(c->wait + i), w);
+        if(c->turnaround != NULL)
+            _mm_storeu_si128((__m128i *)(c->turnaround + i), t);
+        if(c->response != NULL)
+            _mm_storeu_si128((__m128i *)(c->response + i), r);
+        if(c->slowdown != NULL)
+            _mm_storeu_ps(c->slowdown + i, s);
+        metrics_add4(&wait_lo, &wait_hi, w);
+        metrics_add4(&total_lo, &total_hi, t);
+        metrics_add4(&response_lo, &response_hi, r);
+        slowdown_lo = _mm_add_pd(slowdown_lo, _mm_cvtps_pd(s));
+        slowdown_hi = _mm_add_pd(slowdown_hi, _mm_cvtps_pd(_mm_movehl_ps(s, s)));
+        most = metrics_max4(most, t);
+    }
+    wait = metrics_sum2(_mm_add_pd(wait_lo, wait_hi));
+    total = metrics_sum2(_mm_add_pd(total_lo, total_hi));
+    response = metrics_sum2(_mm_add_pd(response_lo, response_hi));
+    slowdown = metrics_sum2(_mm_add_pd(slowdown_lo, slowdown_hi));
+    _mm_storeu_si128((__m128i *)lanes, most);
+    for(k=0; k<4; k++)
+        longest = lanes[k] > longest ? lanes[k] : longest;
+#endif
+    for(; i < hi; i++){
+        turnaround = c->completion[i] - c->arrival[i];
+        burst = c->burst[i] > 1 ? c->burst[i] : 1;
+        ratio = (float)turnaround / (float)burst;
+        if(c->wait != NULL)
+            c->wait[i] = turnaround - c->burst[i];
+        if(c->turnaround != NULL)
+            c->turnaround[i] = turnaround;
+        if(c->response != NULL)
+            c->response[i] = c->first_run[i] - c->arrival[i];
+        if(c->slowdown != NULL)
+            c->slowdown[i] = ratio;
+        wait += turnaround - c->burst[i];
+        total += turnaround;
+        response += c->first_run[i] - c->arrival[i];
+        slowdown += ratio;
+        longest = turnaround > longest ? turnaround : longest;
+    }
+    run->count = hi - lo;
+    run->wait = wait;
+    run->turnaround = total;
+    run->response = response;
+    run->slowdown = slowdown;
+    run->max_turnaround = longest;
+}
+
+/* every run of the columns, runs[r] receiving the sums of run r */
+static void metrics_compute(const struct metrics_columns *c, const int *offsets, int n_runs, struct metrics_run *runs){
+    int r;
+    for(r=0; r<n_runs; r++)
+        metrics_range(c, offsets[r], offsets[r+1], &runs[r]);
+}
+
+#endif
@@ -0,0 +1,34 @@
+/* numa.h - NUMA memory locality
+ *
+ * Each socket of a topology is a NUMA node, and a process may keep its
+ * memory on one, its home. Away from home the memory bound share of its
+ * burst runs slower, the cycles it still needs being restretched whenever
+ * it lands on a core. A process without a valid home runs at full speed.
+ */
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "topology.h"
+
+namespace engine {
+
+// NUMA
+// Stretches are fixed point, numaUnit being full speed
+const int numaUnit = 1024;
+
+// Cycles remaining cycles at stretch from take at stretch to, rounded up
+int restretch(int remaining, int from, int to){
+  if(from == to){
+    return remaining;
+  }
+  long long work = ((long long)remaining * numaUnit + from / 2) / from;
+  return max(1, (int)((work * to + numaUnit - 1) / numaUnit));
+}
+
+// Balancing names of batch jobs and records; naive balancing places and
+// steals as if memory had no home, aware keeps processes at home
+const char* balanceNames[] = {"naive", "aware"};
+
+}
+
+#endif
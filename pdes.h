@@ -0,0 +1,295 @@
+/* pdes.h - conservative parallel run of a cluster
+ *
+ * Host threads each advance a share of the nodes a window of cycles at a
+ * time. At the barrier between windows the last thread in plans the steals
+ * and placements of the next, so results do not depend on the thread count.
+ * A stolen process reaches its new node a window later, waiting meanwhile.
+ */
+#ifndef PDES_H
+#define PDES_H
+
+#include "cluster.h"
+
+namespace engine {
+
+// Parallel cluster simulation
+enum ClusterEventKind{
+  EVENT_ARRIVE,
+  EVENT_STEAL,
+  EVENT_MIGRATED
+};
+
+class ClusterEvent{
+public:
+  int kind;
+  int node;
+  // Node a stolen process goes to and the cycles the move costs it
+  int target;
+  int cost;
+  int time;
+  Process process;
+};
+
+// Lock-free ring of events from one thread to another
+class EventRing{
+public:
+  EventRing(){
+    head = 0;
+    tail = 0;
+  };
+
+  void reserve(int capacity){
+    int size = 1;
+    while(size < capacity){
+      size *= 2;
+    }
+    slots.resize(size);
+  };
+
+  void push(const ClusterEvent& event){
+    size_t t = tail.load(memory_order_relaxed);
+    while(t - head.load(memory_order_acquire) == slots.size()){
+      this_thread::yield();
+    }
+    slots[t & (slots.size() - 1)] = event;
+    tail.store(t + 1, memory_order_release);
+  };
+
+  // Oldest event, NULL if there is none
+  const ClusterEvent* peek(){
+    size_t h = head.load(memory_order_relaxed);
+    if(h == tail.load(memory_order_acquire)){
+      return NULL;
+    }
+    return &slots[h & (slots.size() - 1)];
+  };
+
+  void pop(){
+    head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+  };
+
+private:
+  vector<ClusterEvent> slots;
+  atomic<size_t> head;
+  atomic<size_t> tail;
+};
+
+// Barrier at the end of a window, the last thread in runs the plan
+class WindowBarrier{
+public:
+  WindowBarrier(int countVal){
+    count = countVal;
+    arrived = 0;
+    generation = 0;
+  };
+
+  template <class Plan>
+  void arrive(Plan plan){
+    int g = generation.load(memory_order_acquire);
+    if(arrived.fetch_add(1, memory_order_acq_rel) + 1 == count){
+      plan();
+      arrived.store(0, memory_order_relaxed);
+      generation.store(g + 1, memory_order_release);
+    }else{
+      while(generation.load(memory_order_acquire) == g){
+        this_thread::yield();
+      }
+    }
+  };
+
+private:
+  int count;
+  atomic<int> arrived;
+  atomic<int> generation;
+};
+
+class ParallelCluster{
+public:
+  ParallelCluster(Cluster& clusterVal, int windowVal, int threadsVal)
+    : cluster(clusterVal), barrier(threadsVal){
+    int n = (int)cluster.nodes.size();
+    window = windowVal;
+    threads = threadsVal;
+    finished = false;
+    owner.resize(n);
+    for(int i=0; i < n; i++){
+      owner[i] = (int)((long long)i * threads / n);
+    }
+    plans.resize(threads);
+    rings = vector<EventRing>(threads * threads);
+    // Room for two windows of stolen processes, one per node a window
+    for(int k=0; k < threads * threads; k++){
+      rings[k].reserve(2 * max(1, (int)count(owner.begin(), owner.end(), k % threads)));
+    }
+    landsAt.assign(n, -1);
+    transitWork.assign(n, 0);
+    lastCompletion.assign(n, 0);
+    profiles.resize(threads);
+  };
+
+  void run();
+
+private:
+  Cluster& cluster;
+  WindowBarrier barrier;
+  int window;
+  int threads;
+  bool finished;
+  // Thread of each node, nodes are dealt out in contiguous runs
+  vector<int> owner;
+  // Events of the window for each thread, written by the plan only
+  vector<vector<ClusterEvent> > plans;
+  // rings[from * threads + to] carries stolen processes between threads
+  vector<EventRing> rings;
+  // Cycle a stolen process lands on each node, -1 if none, and its work
+  vector<int> landsAt;
+  vector<long long> transitWork;
+  vector<int> lastCompletion;
+  vector<Profile> profiles;
+  void plan();
+  void work(int self);
+};
+
+// Plans the window starting at cluster.time, every node stopped there
+void ParallelCluster::plan(){
+  int n = (int)cluster.nodes.size();
+  int end = cluster.time + window;
+  ClusterView view;
+  vector<Steal> steals;
+  bool busy = cluster.nextArrival < (int)cluster.arrivals.size();
+  for(int t=0; t < threads; t++){
+    plans[t].clear();
+  }
+  cluster.viewNodes(view);
+  for(int i=0; i < n; i++){
+    if(landsAt[i] >= 0 && landsAt[i] < cluster.time){
+      landsAt[i] = -1;
+      transitWork[i] = 0;
+    }
+    if(landsAt[i] >= 0){
+      view.load[i]++;
+      view.backlog[i] += transitWork[i];
+      busy = true;
+    }
+    busy = busy || !cluster.nodes[i].sim.done();
+  }
+  if(!busy){
+    finished = true;
+    return;
+  }
+  if(cluster.migrationCost >= 0){
+    cluster.planSteals(view, steals);
+  }
+  for(int s=0; s < (int)steals.size(); s++){
+    ClusterEvent event;
+    event.kind = EVENT_STEAL;
+    event.node = steals[s].victim;
+    event.target = steals[s].node;
+    event.cost = steals[s].cost;
+    event.time = end;
+    plans[owner[event.node]].push_back(event);
+    landsAt[event.target] = end;
+    transitWork[event.target] = view.backlog[event.target];
+    cluster.moved(steals[s].pid, steals[s].node, steals[s].distance, steals[s].stretched);
+  }
+  // The waker is the node of the latest completion so far
+  for(int i=0; i < n; i++){
+    if(lastCompletion[i] > 0 && (cluster.waker < 0 || lastCompletion[i] >= lastCompletion[cluster.waker])){
+      cluster.waker = i;
+    }
+  }
+  while(cluster.nextArrival < (int)cluster.arrivals.size() && cluster.arrivals[cluster.nextArrival].arrival < end){
+    ClusterEvent event;
+    event.kind = EVENT_ARRIVE;
+    event.process = cluster.arrivals[cluster.nextArrival++];
+    event.node = cluster.place(view, event.process);
+    event.time = event.process.arrival;
+    plans[owner[event.node]].push_back(event);
+  }
+  cluster.time = end;
+}
+
+void ParallelCluster::work(int self){
+  if(self > 0){
+    profileReset();
+  }
+  while(true){
+    barrier.arrive([this](){ plan(); });
+    if(finished){
+      break;
+    }
+    int end = cluster.time;
+    int start = end - window;
+    // Stolen processes landing this window, in the order of their threads
+    for(int from=0; from < threads; from++){
+      EventRing& ring = rings[from * threads + self];
+      const ClusterEvent* event;
+      while((event = ring.peek()) != NULL && event->time < end){
+        ClusterNode& node = cluster.nodes[event->node];
+        node.sim.arrivals.push_back(event->process);
+        node.backlog += event->process.burst - event->process.completedCycles;
+        node.migratedIn++;
+        ring.pop();
+      }
+    }
+    for(int k=0; k < (int)plans[self].size(); k++){
+      const ClusterEvent& event = plans[self][k];
+      ClusterNode& node = cluster.nodes[event.node];
+      if(event.kind == EVENT_ARRIVE){
+        node.sim.arrivals.push_back(event.process);
+        node.backlog += event.process.burst;
+      }else{
+        ClusterEvent migrated;
+        migrated.kind = EVENT_MIGRATED;
+        migrated.node = event.target;
+        migrated.time = event.time;
+        node.sim.migrateOut(migrated.process);
+        node.backlog -= migrated.process.remainingCycles();
+        // The trip and the cycle it is admitted in count as waiting
+        migrated.process.enters = event.time;
+        migrated.process.wait += window + 1;
+        migrated.process.burst += event.cost;
+        rings[self * threads + owner[event.target]].push(migrated);
+      }
+    }
+    for(int i=0; i < (int)cluster.nodes.size(); i++){
+      if(owner[i] != self){
+        continue;
+      }
+      for(int c=start; c < end; c++){
+        size_t completed = cluster.nodes[i].sim.completed.size();
+        cluster.stepNode(i);
+        if(cluster.nodes[i].sim.completed.size() != completed){
+          lastCompletion[i] = cluster.nodes[i].sim.time;
+        }
+      }
+    }
+  }
+  profiles[self] = profile();
+}
+
+// The cluster ends at its last completion, not at the end of the window
+void ParallelCluster::run(){
+  vector<thread> workers;
+  profileReset();
+  for(int t=1; t < threads; t++){
+    workers.push_back(thread(&ParallelCluster::work, this, t));
+  }
+  work(0);
+  for(int t=0; t < (int)workers.size(); t++){
+    workers[t].join();
+    profileAdd(profiles[t + 1]);
+  }
+  cluster.time = *max_element(lastCompletion.begin(), lastCompletion.end());
+}
+
+// Runs the cluster in windows of window cycles on up to threads threads
+void runClusterParallel(Cluster& cluster, int window, int threads){
+  threads = max(1, min(threads, (int)cluster.nodes.size()));
+  ParallelCluster parallel(cluster, max(1, window), threads);
+  parallel.run();
+}
+
+}
+
+#endif
@@ -0,0 +1,191 @@
+/* procsim.cpp
+* C interface to the scheduling engine of OS.cpp, see procsim.h.
+* The engine comes from engine.h, so it is exactly the one the menu uses.
+*/
+#include <new>
+#include "engine.h"
+#include "procsim.h"
+
+using namespace std;
+
+struct procsim_workload{
+  vector<engine::Process> arrivals;
+};
+
+struct procsim_result{
+  vector<procsim_process> processes;
+  vector<procsim_slice> slices;
+  // Cycle each process was first put on the CPU, in completion order
+  vector<int> firstRun;
+  int cycles;
+};
+
+int procsim_abi_version(void){
+  return PROCSIM_ABI_VERSION;
+}
+
+procsim_workload* procsim_workload_create(int n, const int* pid, const int* arrival, const int* burst, const int* priority){
+  if(n < 0 || (n > 0 && (pid == NULL || arrival == NULL || burst == NULL || priority == NULL))){
+    return NULL;
+  }
+  priority_queue<engine::Process> processes;
+  for(int i=0; i < n; i++){
+    if(burst[i] < 1 || arrival[i] < 0){
+      return NULL;
+    }
+    processes.push(engine::Process(pid[i], arrival[i], burst[i], priority[i]));
+  }
+  procsim_workload* workload = new(nothrow) procsim_workload;
+  if(workload != NULL){
+    // Same arrival order as the menu gets from its priority queue
+    workload->arrivals = engine::arrivalOrder(processes);
+  }
+  return workload;
+}
+
+void procsim_workload_free(procsim_workload* workload){
+  delete workload;
+}
+
+// The process on the cpu after a step runs for the cycle that follows it
+static void recordSlice(vector<procsim_slice>& slices, int pid, int time){
+  if(!slices.empty() && slices.back().pid == pid && slices.back().end == time){
+    slices.back().end++;
+    return;
+  }
+  procsim_slice slice;
+  slice.pid = pid;
+  slice.start = time;
+  slice.end = time + 1;
+  slices.push_back(slice);
+}
+
+procsim_result* procsim_run(const procsim_workload* workload, int policy, int quantum, int aging){
+  if(workload == NULL || policy < PROCSIM_FCFS || policy > PROCSIM_RR || (policy == PROCSIM_RR && quantum < 1)){
+    return NULL;
+  }
+  procsim_result* result = new(nothrow) procsim_result;
+  if(result == NULL){
+    return NULL;
+  }
+  try{
+    engine::Process::setUseAging(aging != 0);
+    engine::Simulation sim(workload->arrivals, policy, policy == PROCSIM_RR?quantum:0);
+    while(!sim.done()){
+      int time = sim.time;
+      sim.step(NULL);
+      if(sim.runningPid() != -1){
+        recordSlice(result->slices, sim.runningPid(), time);
+      }else if(!sim.done()){
+        recordSlice(result->slices, PROCSIM_IDLE, time);
+      }
+    }
+    result->cycles = sim.time;
+    for(int i=0; i < (int)sim.completed.size(); i++){
+      const engine::Process& p = sim.completed[i];
+      procsim_process out;
+      out.pid = p.pid;
+      out.arrival = p.arrival;
+      out.burst = p.burst;
+      out.priority = p.priority;
+      out.wait = p.wait;
+      out.turnaround = p.wait + p.completedCycles;
+      out.completion = p.completion;
+      result->processes.push_back(out);
+      result->firstRun.push_back(p.firstRun);
+    }
+  }catch(const bad_alloc&){
+    delete result;
+    return NULL;
+  }
+  return result;
+}
+
+void procsim_result_free(procsim_result* result){
+  delete result;
+}
+
+int procsim_result_count(const procsim_result* result){
+  return result == NULL?PROCSIM_EINVAL:(int)result->processes.size();
+}
+
+int procsim_result_process(const procsim_result* result, int i, procsim_process* out){
+  if(result == NULL || out == NULL || i < 0 || i >= (int)result->processes.size()){
+    return PROCSIM_EINVAL;
+  }
+  *out = result->processes[i];
+  return 0;
+}
+
+int procsim_result_slices(const procsim_result* result, const procsim_slice** slices){
+  if(result == NULL || slices == NULL){
+    return PROCSIM_EINVAL;
+  }
+  *slices = result->slices.empty()?NULL:&result->slices[0];
+  return (int)result->slices.size();
+}
+
+int procsim_result_cycles(const procsim_result* result){
+  return result == NULL?PROCSIM_EINVAL:result->cycles;
+}
+
+double procsim_result_average_wait(const procsim_result* result){
+  double total = 0;
+  if(result == NULL || result->processes.empty()){
+    return 0;
+  }
+  for(size_t i=0; i < result->processes.size(); i++){
+    total += result->processes[i].wait;
+  }
+  return total / result->processes.size();
+}
+
+double procsim_result_average_turnaround(const procsim_result* result){
+  double total = 0;
+  if(result == NULL || result->processes.empty()){
+    return 0;
+  }
+  for(size_t i=0; i < result->processes.size(); i++){
+    total += result->processes[i].turnaround;
+  }
+  return total / result->processes.size();
+}
+
+// The processes of every result go into one set of columns, so a whole
+// sweep is summed in a single pass of the metrics kernel
+int procsim_results_metrics(const procsim_result* const* results, int n, procsim_metrics* out){
+  if(results == NULL || out == NULL || n < 0){
+    return PROCSIM_EINVAL;
+  }
+  try{
+    vector<int> arrival, firstRun, completion, burst, offsets(1, 0);
+    for(int r=0; r < n; r++){
+      if(results[r] == NULL){
+        return PROCSIM_EINVAL;
+      }
+      const vector<procsim_process>& processes = results[r]->processes;
+      for(size_t i=0; i < processes.size(); i++){
+        arrival.push_back(processes[i].arrival);
+        completion.push_back(processes[i].completion);
+        burst.push_back(processes[i].burst);
+      }
+      firstRun.insert(firstRun.end(), results[r]->firstRun.begin(), results[r]->firstRun.end());
+      offsets.push_back((int)arrival.size());
+    }
+    metrics_columns columns = {arrival.data(), firstRun.data(), completion.data(), burst.data(), NULL, NULL, NULL, NULL};
+    vector<metrics_run> sums(n);
+    metrics_compute(&columns, offsets.data(), n, sums.data());
+    for(int r=0; r < n; r++){
+      double count = sums[r].count?sums[r].count:1;
+      out[r].processes = sums[r].count;
+      out[r].average_wait = sums[r].wait / count;
+      out[r].average_turnaround = sums[r].turnaround / count;
+      out[r].average_response = sums[r].response / count;
+      out[r].average_slowdown = sums[r].slowdown / count;
+      out[r].max_turnaround = sums[r].max_turnaround;
+    }
+  }catch(const bad_alloc&){
+    return PROCSIM_EINVAL;
+  }
+  return n;
+}
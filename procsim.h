@@ -0,0 +1,122 @@
+/* procsim.h - C interface to the OS.cpp scheduling engine
+ *
+ * A workload is built from plain arrays, run under one policy and the
+ * result is read back as per-process times and a slice timeline, so
+ * callers link the engine in-process instead of driving the menu.
+ * Every object is opaque and owned by the caller once created; results
+ * do not refer back to their workload.
+ *
+ * Build:
+ *  static: g++ -O2 -c procsim.cpp && ar rcs libprocsim.a procsim.o
+ *  shared: g++ -O2 -shared -fPIC -fvisibility=hidden procsim.cpp -o libprocsim.so
+ * C programs link with -lprocsim -lstdc++.
+ *
+ * Runs on different threads do not share any state: the engine keeps its
+ * aging switch per thread.
+ */
+#ifndef PROCSIM_H
+#define PROCSIM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(PROCSIM_SHARED)
+#define PROCSIM_API __declspec(dllexport)
+#elif defined(__GNUC__)
+#define PROCSIM_API __attribute__((visibility("default")))
+#else
+#define PROCSIM_API
+#endif
+
+/* bumped whenever a signature or struct below changes */
+#define PROCSIM_ABI_VERSION 1
+
+/* policies, numbered as in the OS.cpp menu */
+#define PROCSIM_FCFS 1
+#define PROCSIM_SRTF 2
+#define PROCSIM_PRIORITY 3
+#define PROCSIM_PREEMPTIVE_PRIORITY 4
+#define PROCSIM_RR 5
+
+/* error returned instead of a count */
+#define PROCSIM_EINVAL -1
+
+/* pid of a slice where the CPU was idle */
+#define PROCSIM_IDLE -1
+
+typedef struct procsim_workload procsim_workload;
+typedef struct procsim_result procsim_result;
+
+struct procsim_process{
+    int pid;
+    int arrival;
+    int burst;
+    int priority;
+    int wait;
+    int turnaround;
+    int completion;
+    /*
+        pid, arrival, burst, priority - as given to the workload
+        wait - cycles spent ready but off the CPU
+        turnaround - cycles from arrival to completion
+        completion - cycle the process finished in
+    */
+};
+
+struct procsim_metrics{
+    int processes;
+    double average_wait;
+    double average_turnaround;
+    double average_response;
+    double average_slowdown;
+    int max_turnaround;
+    /*
+        processes - processes the result holds
+        average_response - mean cycles from arrival to first reaching the CPU
+        average_slowdown - mean turnaround over burst, bursts below 1 as 1
+        max_turnaround - longest turnaround, 0 without processes
+    */
+};
+
+struct procsim_slice{
+    int pid;
+    int start;
+    int end;
+    /*
+        pid - process on the CPU, or PROCSIM_IDLE
+        start, end - cycles [start, end) it ran without interruption
+    */
+};
+
+PROCSIM_API int procsim_abi_version(void);
+
+/* n processes, arrays of n values each; NULL on bad input or no memory */
+PROCSIM_API procsim_workload *procsim_workload_create(int n, const int *pid, const int *arrival,
+                                                      const int *burst, const int *priority);
+PROCSIM_API void procsim_workload_free(procsim_workload *workload);
+
+/* quantum is only used by PROCSIM_RR, aging is 0 or 1; NULL on bad input */
+PROCSIM_API procsim_result *procsim_run(const procsim_workload *workload, int policy, int quantum, int aging);
+PROCSIM_API void procsim_result_free(procsim_result *result);
+
+/* processes in completion order; procsim_result_process returns 0 or PROCSIM_EINVAL */
+PROCSIM_API int procsim_result_count(const procsim_result *result);
+PROCSIM_API int procsim_result_process(const procsim_result *result, int i, struct procsim_process *out);
+
+/* slices in time order; the array lives as long as the result */
+PROCSIM_API int procsim_result_slices(const procsim_result *result, const struct procsim_slice **slices);
+
+PROCSIM_API int procsim_result_cycles(const procsim_result *result);
+PROCSIM_API double procsim_result_average_wait(const procsim_result *result);
+PROCSIM_API double procsim_result_average_turnaround(const procsim_result *result);
+
+/* metrics of n results at once, out[i] for results[i], e.g. every cell of a
+   sweep; returns n or PROCSIM_EINVAL */
+PROCSIM_API int procsim_results_metrics(const procsim_result *const *results, int n, struct procsim_metrics *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,183 @@
+// profile.h - self-profiling counters of the C++ schedulers
+//
+// Counts what the engine did during a run (arrivals, dispatches,
+// preemptions, sorts, queue high-water mark) and how long each phase
+// of a clock cycle took. Counters are thread local, so concurrent runs
+// each see their own. Phase time is taken with one clock read per phase
+// boundary: a lap charges the time since the previous lap to the phase
+// that just ended. On x86 the clock is the time-stamp counter, converted
+// to nanoseconds against steady_clock over the whole run when reported;
+// elsewhere it is steady_clock itself.
+//
+// Compile with -DNO_PROFILE to compile every counter and timer out, or
+// with -DNO_PROFILE_TIMERS to keep the counters only: a clock read costs
+// tens of nanoseconds, several times a cycle, while a counter is an add.
+//
+// Environment:
+//  PROFILE_JSON - file each report also appends its profile to, one
+//                 JSON object per line
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <ostream>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILE_TSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILE_TSC
+#endif
+
+enum ProfilePhase{
+  PHASE_WAITS,
+  PHASE_ARRIVALS,
+  PHASE_SORT,
+  PHASE_CPU,
+  PHASE_LOG,
+  PHASE_COUNT
+};
+
+class Profile{
+public:
+  long long cycles;
+  long long arrivals;
+  long long dispatches;
+  long long preemptions;
+  long long completions;
+  long long sorts;
+  long long idleCycles;
+  long long waitingHighWater;
+  long long ticks[PHASE_COUNT];
+  long long lap;
+  long long startTicks;
+  std::chrono::steady_clock::time_point start;
+};
+
+inline long long profileTicks(){
+#ifdef PROFILE_TSC
+  return (long long)__rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+inline Profile& profile(){
+  static thread_local Profile counters;
+  return counters;
+}
+
+inline void profileReset(){
+  profile() = Profile();
+  profile().start = std::chrono::steady_clock::now();
+  profile().startTicks = profileTicks();
+}
+
+// Adds the counts and phase times of another thread's run, so a run
+// spread over threads reports as one
+inline void profileAdd(const Profile& other){
+  Profile& p = profile();
+  p.cycles += other.cycles;
+  p.arrivals += other.arrivals;
+  p.dispatches += other.dispatches;
+  p.preemptions += other.preemptions;
+  p.completions += other.completions;
+  p.sorts += other.sorts;
+  p.idleCycles += other.idleCycles;
+  if(other.waitingHighWater > p.waitingHighWater){
+    p.waitingHighWater = other.waitingHighWater;
+  }
+  for(int i=0; i < PHASE_COUNT; i++){
+    p.ticks[i] += other.ticks[i];
+  }
+}
+
+// Charges the time since the last lap to phase
+inline void profileLap(int phase){
+  long long now = profileTicks();
+  profile().ticks[phase] += now - profile().lap;
+  profile().lap = now;
+}
+
+// Time spent in a phase since the last reset
+inline long long profileNanoseconds(int phase){
+#ifdef PROFILE_TSC
+  const Profile& p = profile();
+  double wall = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - p.start).count();
+  long long elapsed = profileTicks() - p.startTicks;
+  return elapsed > 0?(long long)(p.ticks[phase] * (wall / elapsed)):0;
+#else
+  return profile().ticks[phase];
+#endif
+}
+
+#ifdef NO_PROFILE
+#define PROFILE_COUNT(field)
+#define PROFILE_HIGH(field, value)
+#define PROFILE_START()
+#define PROFILE_LAP(phase)
+#else
+#define PROFILE_COUNT(field) (profile().field++)
+#define PROFILE_HIGH(field, value) \
+  do{ if((long long)(value) > profile().field) profile().field = (value); }while(0)
+#ifdef NO_PROFILE_TIMERS
+#define PROFILE_START()
+#define PROFILE_LAP(phase)
+#else
+#define PROFILE_START() (profile().lap = profileTicks())
+#define PROFILE_LAP(phase) profileLap(phase)
+#endif
+#endif
+
+inline const char* profilePhaseName(int phase){
+  static const char* names[PHASE_COUNT] = {"waits", "arrivals", "sort", "cpu", "log"};
+  return names[phase];
+}
+
+inline void printProfileJSON(std::ostream& os, const char* label){
+  const Profile& p = profile();
+  os << "{\"run\":\"" << label << "\",\"cycles\":" << p.cycles << ",\"arrivals\":" << p.arrivals
+     << ",\"dispatches\":" << p.dispatches << ",\"preemptions\":" << p.preemptions
+     << ",\"completions\":" << p.completions << ",\"sorts\":" << p.sorts
+     << ",\"idle_cycles\":" << p.idleCycles << ",\"waiting_high_water\":" << p.waitingHighWater
+     << ",\"ns\":{";
+  for(int i=0; i < PHASE_COUNT; i++){
+    os << (i?",\"":"\"") << profilePhaseName(i) << "\":" << profileNanoseconds(i);
+  }
+  os << "}}" << std::endl;
+}
+
+// Appends the profile to the PROFILE_JSON file, if one is set
+inline void appendProfileJSON(const char* label){
+  const char* path = std::getenv("PROFILE_JSON");
+  if(path != NULL){
+    std::ofstream json(path, std::ios::app);
+    printProfileJSON(json, label);
+  }
+}
+
+// Summary at the end of a report, label names the run in the JSON copy
+inline void printProfile(std::ostream& os, const char* label){
+#ifndef NO_PROFILE
+  const Profile& p = profile();
+  long long total = 0;
+  os << "Profile" << std::endl;
+  os << "Cycles: " << p.cycles << "\tIdle: " << p.idleCycles << std::endl;
+  os << "Arrivals: " << p.arrivals << "\tDispatches: " << p.dispatches
+     << "\tPreemptions: " << p.preemptions << "\tCompletions: " << p.completions << std::endl;
+  os << "Sorts: " << p.sorts << "\tWaiting high-water: " << p.waitingHighWater << std::endl;
+  for(int i=0; i < PHASE_COUNT; i++){
+    total += profileNanoseconds(i);
+  }
+  os << "Engine time: " << total << " ns (";
+  for(int i=0; i < PHASE_COUNT; i++){
+    os << (i?", ":"") << profilePhaseName(i) << " " << profileNanoseconds(i);
+  }
+  os << ")" << std::endl;
+  appendProfileJSON(label);
+#endif
+}
+
+#endif
@@ -0,0 +1,227 @@
+/* replicate.h - Monte Carlo replications of a run
+ *
+ * Each replication draws a workload from a model of the loaded one,
+ * Poisson arrivals at its rate with the burst and priority of a random
+ * one of its processes, and runs it. Draw r is seeded with seed + r, so
+ * results depend on the seed alone, and a compared policy runs on the same
+ * draws.
+ */
+#ifndef REPLICATE_H
+#define REPLICATE_H
+
+#include "engine.h"
+
+namespace engine {
+
+// Monte Carlo replications
+// Rounds of replications run on threads until every interval is within
+// precision
+const int replicateRound = 8;
+
+class ReplicaModel{
+public:
+  // Processes whose burst and priority are drawn, arrivals per cycle and
+  // first arrival
+  vector<Process> shapes;
+  double rate;
+  int start;
+};
+
+ReplicaModel fitReplicaModel(const vector<Process>& arrivals){
+  ReplicaModel model;
+  model.shapes = arrivals;
+  model.rate = fitWorkload(arrivals).rate;
+  model.start = arrivals.empty()?0:arrivals[0].arrival;
+  for(int i=1; i < (int)arrivals.size(); i++){
+    model.start = min(model.start, arrivals[i].arrival);
+  }
+  return model;
+}
+
+// Workload of draw seed, in arrival order. Uses the generator's raw
+// output, <random>'s distributions differ between standard libraries.
+vector<Process> drawWorkload(const ReplicaModel& model, unsigned seed){
+  mt19937 random(seed);
+  vector<Process> drawn;
+  double arrival = model.start;
+  for(int i=0; i < (int)model.shapes.size(); i++){
+    if(i > 0 && model.rate < numeric_limits<double>::infinity()){
+      arrival += -log((random() + 0.5) / 4294967296.0) / model.rate;
+    }
+    const Process& shape = model.shapes[random() % model.shapes.size()];
+    drawn.push_back(Process(i + 1, (int)arrival, shape.burst, shape.priority));
+  }
+  return drawn;
+}
+
+// Metrics of one replication
+class Replica{
+public:
+  double wait;
+  double turnaround;
+  double p50;
+  double p99;
+};
+
+Replica runReplica(const vector<Process>& arrivals, int policy, int timeQuantum){
+  Simulation sim(arrivals, policy, timeQuantum);
+  while(!sim.done()){
+    sim.step(NULL);
+  }
+  Replica replica;
+  vector<int> turnaround;
+  double waits = 0;
+  for(int i=0; i < (int)sim.completed.size(); i++){
+    waits += sim.completed[i].wait;
+    turnaround.push_back(sim.completed[i].wait + sim.completed[i].burst);
+  }
+  double n = max(1, (int)sim.completed.size());
+  sort(turnaround.begin(), turnaround.end());
+  replica.wait = waits / n;
+  replica.turnaround = accumulate(turnaround.begin(), turnaround.end(), 0.0) / n;
+  replica.p50 = percentileOf(turnaround, 50);
+  replica.p99 = percentileOf(turnaround, 99);
+  return replica;
+}
+
+// 97.5th percentile of Student's t with df degrees of freedom, for two
+// sided 95% intervals; past the table the series in 1/df is within 0.001
+double studentT975(int df){
+  static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if(df < 1){
+    return numeric_limits<double>::infinity();
+  }
+  return df <= 30?table[df - 1]:1.95996 + 2.3722 / df;
+}
+
+// Mean of a sample and the half width of its 95% confidence interval
+class Interval{
+public:
+  double mean;
+  double half;
+};
+
+Interval confidence(const vector<double>& values){
+  Interval interval;
+  double n = values.size(), squares = 0;
+  interval.mean = values.empty()?0:accumulate(values.begin(), values.end(), 0.0) / n;
+  for(int i=0; i < (int)values.size(); i++){
+    squares += (values[i] - interval.mean) * (values[i] - interval.mean);
+  }
+  interval.half = values.size() < 2?numeric_limits<double>::infinity()
+                                   :studentT975((int)n - 1) * sqrt(squares / (n - 1) / n);
+  return interval;
+}
+
+// Names of the metrics of a replication, as rows and record fields
+const char* replicaMetricNames[] = {"Average Wait", "Average Turnaround", "Median Turnaround", "99th Percentile Turnaround"};
+const char* replicaMetricKeys[] = {"wait", "turnaround", "p50", "p99"};
+
+double replicaMetric(const Replica& replica, int metric){
+  double values[] = {replica.wait, replica.turnaround, replica.p50, replica.p99};
+  return values[metric];
+}
+
+class Replication{
+public:
+  vector<Replica> runs;
+  // Runs of the policy compared with, on the same draws, if there is one
+  vector<Replica> others;
+  // Intervals of each metric, and of its difference from the other policy
+  Interval metrics[4];
+  Interval differences[4];
+  bool converged;
+};
+
+// Interval of each metric over the replications run so far
+void replicationIntervals(Replication& replication){
+  for(int m=0; m < 4; m++){
+    vector<double> values, differences;
+    for(int r=0; r < (int)replication.runs.size(); r++){
+      values.push_back(replicaMetric(replication.runs[r], m));
+      if(!replication.others.empty()){
+        differences.push_back(replicaMetric(replication.runs[r], m) - replicaMetric(replication.others[r], m));
+      }
+    }
+    replication.metrics[m] = confidence(values);
+    replication.differences[m] = confidence(differences);
+  }
+}
+
+// Up to most replications of policy, and of other on the same draws
+// unless it is 0, until every interval is within precision (a fraction
+// of its mean)
+Replication replicate(const vector<Process>& arrivals, int policy, int other, int timeQuantum, bool aging,
+                      int most, double precision, unsigned seed, int threads){
+  ReplicaModel model = fitReplicaModel(arrivals);
+  Replication replication;
+  replication.converged = false;
+  while((int)replication.runs.size() < most && !replication.converged){
+    int from = (int)replication.runs.size();
+    int to = min(most, from + replicateRound);
+    replication.runs.resize(to);
+    replication.others.resize(other?to:0);
+    atomic<int> next(from);
+    vector<thread> workers;
+    for(int t=0; t < min(threads, to - from); t++){
+      workers.push_back(thread([&](){
+        int r;
+        Process::setUseAging(aging);
+        while((r = next++) < to){
+          vector<Process> drawn = drawWorkload(model, seed + r);
+          replication.runs[r] = runReplica(drawn, policy, timeQuantum);
+          if(other){
+            replication.others[r] = runReplica(drawn, other, timeQuantum);
+          }
+        }
+      }));
+    }
+    for(int t=0; t < (int)workers.size(); t++){
+      workers[t].join();
+    }
+    replicationIntervals(replication);
+    replication.converged = true;
+    for(int m=0; m < 4; m++){
+      Interval& interval = replication.metrics[m];
+      replication.converged = replication.converged && interval.half <= precision * fabs(interval.mean);
+    }
+  }
+  return replication;
+}
+
+const report_column replicationColumns[] = {
+  {"metric", "Metric", 0}, {"mean", "Mean", 0}, {"low", "Low", 0}, {"high", "High", 0}
+};
+
+// Means and 95% intervals of a replication, and of its differences from
+// other (named by its policy) if it ran
+void printReplication(const Replication& replication, int other, ostream& os){
+  report out;
+  report_begin(&out, reportToStream, &os, "replications", replicationColumns, 4, REPORT_TABS);
+  report_title(&out, "Replications, with 95% confidence intervals\n");
+  for(int m=0; m < 4; m++){
+    const Interval& interval = replication.metrics[m];
+    report_text(&out, replicaMetricNames[m]);
+    report_real(&out, interval.mean, 2);
+    report_real(&out, interval.mean - interval.half, 2);
+    report_real(&out, interval.mean + interval.half, 2);
+  }
+  for(int m=0; other && m < 4; m++){
+    const Interval& interval = replication.differences[m];
+    string name = string(replicaMetricNames[m]) + " minus " + policyName(other);
+    report_text(&out, name.c_str());
+    report_real(&out, interval.mean, 2);
+    report_real(&out, interval.mean - interval.half, 2);
+    report_real(&out, interval.mean + interval.half, 2);
+  }
+  report_value_int(&out, "replications", "Replications: ", (long long)replication.runs.size());
+  report_value_int(&out, "converged", "Converged: ", replication.converged);
+  report_end(&out);
+  os.flush();
+}
+
+}
+
+#endif
@@ -0,0 +1,378 @@
+/* report.h - result tables as text, CSV or JSON
+ *
+ * Shared by the C and C++ front-ends. A report is a table, row after row,
+ * followed by summary values, buffered and handed to a write function as
+ * the buffer fills. Tables are tab separated, boxed or labelled; CSV adds
+ * the summary as metric,value lines; JSON is one object per report,
+ *  {"report":NAME,"rows":[{KEY:VALUE,...},...],"summary":{KEY:VALUE,...}}
+ *
+ * Environment:
+ *  REPORT_FORMAT - table (default), csv or json
+ */
+#ifndef REPORT_H
+#define REPORT_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define REPORT_TABLE 0
+#define REPORT_CSV 1
+#define REPORT_JSON 2
+
+#define REPORT_TABS 0
+#define REPORT_BOXED 1
+#define REPORT_LABELLED 2
+
+#define REPORT_BUFFER 4096
+
+struct report_column{
+    const char *key;
+    const char *label;
+    int width;
+    /*
+        key - CSV header and JSON field name
+        label - table header, or the text before each value when labelled
+        width - cell width of a boxed table
+    */
+};
+
+struct report{
+    void (*write)(const char *data, size_t n, void *ctx);
+    void *ctx;
+    const char *name;
+    const struct report_column *columns;
+    int n_columns, format, layout;
+    const char *row_begin, *row_end, *value_end;
+    /*
+        write - takes the formatted output, ctx is handed to it
+        name - names the report in JSON
+        format - REPORT_TABLE, REPORT_CSV or REPORT_JSON
+        layout - REPORT_TABS, REPORT_BOXED or REPORT_LABELLED tables
+        row_begin, row_end - around every row, and the header of a tab separated table
+        value_end - after each summary value of a table
+    */
+    int col, header, rows_closed;
+    long rows, values;
+    size_t used;
+    char buf[REPORT_BUFFER];
+    /*
+        col - next column of the row being written
+        header - whether the header is out
+        rows_closed - no more rows, summary values may follow
+        rows, values - rows and summary values written so far
+        used - bytes of buf not handed to write yet
+    */
+};
+
+/* write function for a FILE *, given as ctx */
+static inline void report_file_write(const char *data, size_t n, void *ctx){
+    fwrite(data, 1, n, (FILE *)ctx);
+}
+
+/* format chosen by REPORT_FORMAT */
+static inline int report_format(void){
+    const char *env = getenv("REPORT_FORMAT");
+    if(env != NULL && strcmp(env, "csv") == 0)
+        return REPORT_CSV;
+    if(env != NULL && strcmp(env, "json") == 0)
+        return REPORT_JSON;
+    return REPORT_TABLE;
+}
+
+static inline int report_human(const struct report *r){
+    return r->format == REPORT_TABLE;
+}
+
+static inline void report_flush(struct report *r){
+    if(r->used > 0)
+        r->write(r->buf, r->used, r->ctx);
+    r->used = 0;
+}
+
+static inline void report_put(struct report *r, const char *s, size_t n){
+    size_t chunk;
+    while(n > 0){
+        chunk = REPORT_BUFFER - r->used < n ? REPORT_BUFFER - r->used : n;
+        memcpy(r->buf + r->used, s, chunk);
+        r->used += chunk;
+        s += chunk;
+        n -= chunk;
+        if(r->used == REPORT_BUFFER)
+            report_flush(r);
+    }
+}
+
+static inline void report_puts(struct report *r, const char *s){
+    report_put(r, s, strlen(s));
+}
+
+static inline void report_repeat(struct report *r, char c, int n){
+    int chunk;
+    while(n > 0){
+        chunk = (int)(REPORT_BUFFER - r->used) < n ? (int)(REPORT_BUFFER - r->used) : n;
+        memset(r->buf + r->used, c, chunk);
+        r->used += chunk;
+        n -= chunk;
+        if(r->used == REPORT_BUFFER)
+            report_flush(r);
+    }
+}
+
+/* decimal digits of v into out, which holds at least 21 chars; returns the length */
+static inline int report_itoa(char *out, long long v){
+    char digits[24];
+    unsigned long long u = v < 0 ? 0ULL - (unsigned long long)v : (unsigned long long)v;
+    int n = 0, len = 0;
+    do{
+        digits[n++] = (char)('0' + u % 10);
+        u /= 10;
+    }while(u > 0);
+    if(v < 0)
+        out[len++] = '-';
+    while(n > 0)
+        out[len++] = digits[--n];
+    return len;
+}
+
+/* text as a JSON string, or a CSV field quoted when it has to be */
+static inline void report_quoted(struct report *r, const char *s, size_t n){
+    size_t i;
+    if(r->format == REPORT_CSV && strcspn(s, ",\"\n") >= n){
+        report_put(r, s, n);
+        return;
+    }
+    report_put(r, "\"", 1);
+    for(i=0; i<n; i++){
+        if(s[i] == '"')
+            report_put(r, r->format == REPORT_CSV ? "\"" : "\\", 1);
+        else if(s[i] == '\\' && r->format == REPORT_JSON)
+            report_put(r, "\\", 1);
+        if(s[i] == '\n' && r->format == REPORT_JSON)
+            report_put(r, "\\n", 2);
+        else
+            report_put(r, s + i, 1);
+    }
+    report_put(r, "\"", 1);
+}
+
+static inline void report_border(struct report *r){
+    int i;
+    report_put(r, "+", 1);
+    for(i=0; i<r->n_columns; i++){
+        report_repeat(r, '-', r->columns[i].width);
+        report_put(r, "+", 1);
+    }
+    report_put(r, "\n", 1);
+}
+
+static inline void report_header(struct report *r){
+    int i, pad;
+    r->header = 1;
+    if(r->format == REPORT_JSON){
+        report_puts(r, "{\"report\":");
+        report_quoted(r, r->name, strlen(r->name));
+        report_puts(r, ",\"rows\":[");
+    }
+    else if(r->format == REPORT_CSV){
+        for(i=0; i<r->n_columns; i++){
+            if(i > 0)
+                report_put(r, ",", 1);
+            report_puts(r, r->columns[i].key);
+        }
+        if(r->n_columns > 0)
+            report_put(r, "\n", 1);
+    }
+    else if(r->layout == REPORT_TABS && r->n_columns > 0){
+        report_puts(r, r->row_begin);
+        for(i=0; i<r->n_columns; i++){
+            if(i > 0)
+                report_put(r, "\t", 1);
+            report_puts(r, r->columns[i].label);
+        }
+        report_puts(r, r->row_end);
+    }
+    else if(r->layout == REPORT_BOXED){
+        report_border(r);
+        for(i=0; i<r->n_columns; i++){
+            pad = r->columns[i].width - (int)strlen(r->columns[i].label);
+            report_put(r, "|", 1);
+            report_repeat(r, ' ', pad / 2);
+            report_puts(r, r->columns[i].label);
+            report_repeat(r, ' ', pad - pad / 2);
+        }
+        report_puts(r, "|\n");
+        report_border(r);
+    }
+}
+
+/* starts a report of n_columns columns written through write */
+static inline void report_begin(struct report *r, void (*write)(const char *, size_t, void *), void *ctx,
+                         const char *name, const struct report_column *columns, int n_columns, int layout){
+    r->write = write;
+    r->ctx = ctx;
+    r->name = name;
+    r->columns = columns;
+    r->n_columns = n_columns;
+    r->format = report_format();
+    r->layout = layout;
+    r->row_begin = "";
+    r->row_end = "\n";
+    r->value_end = "\n";
+    r->col = r->header = r->rows_closed = 0;
+    r->rows = r->values = 0;
+    r->used = 0;
+}
+
+/* text written as is before a table, left out of CSV and JSON */
+static inline void report_title(struct report *r, const char *text){
+    if(r->format == REPORT_TABLE)
+        report_puts(r, text);
+}
+
+/* next cell of the row, text a string value if quoted */
+static inline void report_cell(struct report *r, const char *text, size_t n, int quoted){
+    const struct report_column *column = &r->columns[r->col];
+    int pad;
+    if(!r->header)
+        report_header(r);
+    if(r->format == REPORT_JSON){
+        report_put(r, r->col > 0 ? "," : r->rows > 0 ? ",{" : "{", r->col > 0 || r->rows == 0 ? 1 : 2);
+        report_quoted(r, column->key, strlen(column->key));
+        report_put(r, ":", 1);
+        if(quoted)
+            report_quoted(r, text, n);
+        else
+            report_put(r, text, n);
+    }
+    else if(r->format == REPORT_CSV){
+        if(r->col > 0)
+            report_put(r, ",", 1);
+        if(quoted)
+            report_quoted(r, text, n);
+        else
+            report_put(r, text, n);
+    }
+    else if(r->layout == REPORT_BOXED){/*centred, an odd spare column going to the right*/
+        pad = column->width / 2 - ((int)n + 1) / 2;
+        report_put(r, "|", 1);
+        report_repeat(r, ' ', pad);
+        report_put(r, text, n);
+        report_repeat(r, ' ', column->width - (int)n - (pad > 0 ? pad : 0));
+    }
+    else if(r->layout == REPORT_LABELLED){
+        if(r->col == 0)
+            report_puts(r, r->row_begin);
+        report_puts(r, column->label);
+        report_put(r, text, n);
+    }
+    else{
+        report_puts(r, r->col == 0 ? r->row_begin : "\t");
+        report_put(r, text, n);
+    }
+    if(++r->col < r->n_columns)
+        return;
+    r->col = 0;
+    r->rows++;
+    if(r->format == REPORT_JSON)
+        report_put(r, "}", 1);
+    else if(r->format == REPORT_CSV)
+        report_put(r, "\n", 1);
+    else if(r->layout == REPORT_BOXED)
+        report_puts(r, "|\n");
+    else
+        report_puts(r, r->row_end);
+}
+
+static inline void report_int(struct report *r, long long v){
+    char text[24];
+    report_cell(r, text, report_itoa(text, v), 0);
+}
+
+/* id shown as prefix and number in a table, as the number alone elsewhere */
+static inline void report_id(struct report *r, const char *prefix, long long v){
+    char text[64];
+    size_t n = 0;
+    if(r->format == REPORT_TABLE){
+        n = strlen(prefix) < 32 ? strlen(prefix) : 32;
+        memcpy(text, prefix, n);
+    }
+    n += report_itoa(text + n, v);
+    report_cell(r, text, n, 0);
+}
+
+/* v with decimals digits after the point, or as printf's %g if decimals < 0 */
+static inline int report_ftoa(const struct report *r, char *out, double v, int decimals){
+    if(r->format == REPORT_JSON && (v != v || v - v != 0)){/*NaN and infinities are not JSON*/
+        strcpy(out, "null");
+        return 4;
+    }
+    return decimals < 0 ? sprintf(out, "%g", v) : sprintf(out, "%.*f", decimals > 9 ? 9 : decimals, v);
+}
+
+static inline void report_real(struct report *r, double v, int decimals){
+    char text[352];
+    report_cell(r, text, report_ftoa(r, text, v, decimals), 0);
+}
+
+static inline void report_text(struct report *r, const char *s){
+    report_cell(r, s, strlen(s), 1);
+}
+
+/* ends the rows: the bottom border of a boxed table, the rows of JSON */
+static inline void report_close_rows(struct report *r){
+    if(!r->header)
+        report_header(r);
+    if(r->rows_closed)
+        return;
+    r->rows_closed = 1;
+    if(r->format == REPORT_JSON)
+        report_put(r, "]", 1);
+    else if(r->format == REPORT_TABLE && r->layout == REPORT_BOXED)
+        report_border(r);
+}
+
+/* summary value, shown after its label in a table */
+static inline void report_value(struct report *r, const char *key, const char *label, const char *text, size_t n){
+    report_close_rows(r);
+    if(r->format == REPORT_JSON){
+        report_puts(r, r->values > 0 ? "," : ",\"summary\":{");
+        report_quoted(r, key, strlen(key));
+        report_put(r, ":", 1);
+        report_put(r, text, n);
+    }
+    else if(r->format == REPORT_CSV){
+        if(r->values == 0)
+            report_puts(r, r->n_columns > 0 ? "\nmetric,value\n" : "metric,value\n");
+        report_puts(r, key);
+        report_put(r, ",", 1);
+        report_put(r, text, n);
+        report_put(r, "\n", 1);
+    }
+    else{
+        report_puts(r, label);
+        report_put(r, text, n);
+        report_puts(r, r->value_end);
+    }
+    r->values++;
+}
+
+static inline void report_value_int(struct report *r, const char *key, const char *label, long long v){
+    char text[24];
+    report_value(r, key, label, text, report_itoa(text, v));
+}
+
+static inline void report_value_real(struct report *r, const char *key, const char *label, double v, int decimals){
+    char text[352];
+    report_value(r, key, label, text, report_ftoa(r, text, v, decimals));
+}
+
+/* closes the report and writes out what is left */
+static inline void report_end(struct report *r){
+    report_close_rows(r);
+    if(r->format == REPORT_JSON)
+        report_puts(r, r->values > 0 ? "}}\n" : "}\n");
+    report_flush(r);
+}
+
+#endif
@@ -0,0 +1,126 @@
+/* topology.h - SMP topology and processor affinity
+ *
+ * The nodes of a cluster as the cores of one machine, grouped by shared L2,
+ * LLC and socket. A process starting on a core some distance from its last
+ * one pays that distance's cycles on top of its burst; the flat default
+ * topology charges nothing.
+ */
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include "engine.h"
+
+namespace engine {
+
+// SMP topology
+// Distance of two cores, the lowest level they share
+enum Distance{
+  DISTANCE_CORE,
+  DISTANCE_L2,
+  DISTANCE_LLC,
+  DISTANCE_SOCKET,
+  DISTANCE_REMOTE,
+  DISTANCES
+};
+
+// Distance names of batch jobs and records
+const char* distanceNames[] = {"core", "l2", "llc", "socket", "remote"};
+
+class Topology{
+public:
+  Topology(){
+    sockets = 1;
+    llcs = 1;
+    l2s = 1;
+    cores = 1;
+    fill(cost, cost + DISTANCES, 0);
+    described = false;
+  };
+
+  // Cores per L2, L2 groups per LLC, LLC groups per socket and sockets
+  int cores;
+  int l2s;
+  int llcs;
+  int sockets;
+  // Cycles a process pays for starting at each distance from its last core
+  int cost[DISTANCES];
+  // Set once parsed, so reports know to show the distances
+  bool described;
+
+  int coreCount() const{
+    return sockets * llcs * l2s * cores;
+  };
+
+  int distance(int a, int b) const{
+    if(a == b){
+      return DISTANCE_CORE;
+    }else if(a / cores == b / cores){
+      return DISTANCE_L2;
+    }else if(a / (cores * l2s) == b / (cores * l2s)){
+      return DISTANCE_LLC;
+    }else if(a / (cores * l2s * llcs) == b / (cores * l2s * llcs)){
+      return DISTANCE_SOCKET;
+    }
+    return DISTANCE_REMOTE;
+  };
+
+  // NUMA node of a core, one per socket
+  int numaNode(int core) const{
+    return core / (cores * l2s * llcs);
+  };
+};
+
+// Parses "SxLxMxC", sockets of L LLC groups of M L2 groups of C cores,
+// false unless every count is at least 1
+bool parseTopology(const string& text, Topology& topology){
+  char x1, x2, x3;
+  stringstream ss(text);
+  if(!(ss >> topology.sockets >> x1 >> topology.llcs >> x2 >> topology.l2s >> x3 >> topology.cores)
+     || x1 != 'x' || x2 != 'x' || x3 != 'x' || !ss.eof()){
+    return false;
+  }
+  topology.described = true;
+  return topology.sockets > 0 && topology.llcs > 0 && topology.l2s > 0 && topology.cores > 0;
+}
+
+// Parses "L2,LLC,SOCKET,REMOTE", the cycles of each distance past the core
+bool parseDistanceCosts(const string& text, Topology& topology){
+  string spaced = text;
+  replace(spaced.begin(), spaced.end(), ',', ' ');
+  stringstream ss(spaced);
+  for(int d=DISTANCE_L2; d < DISTANCES; d++){
+    if(!(ss >> topology.cost[d]) || topology.cost[d] < 0){
+      return false;
+    }
+  }
+  return ss.eof();
+}
+
+// Affinity
+// Where a process that ran before goes back to, a pid arriving again being
+// the same task waking up. Soft: its last core unless that has more than
+// one process above the least loaded. Hard: the LLC group it first ran on.
+// Wake: its last core, or its waker, if idle, else the nearest idle core
+// in its LLC. Soft and wake steal from the nearest queue with work.
+enum Affinity{
+  AFFINITY_NONE,
+  AFFINITY_SOFT,
+  AFFINITY_HARD,
+  AFFINITY_WAKE
+};
+
+// Affinity names of batch jobs and records
+const char* affinityNames[] = {"none", "soft", "hard", "wake"};
+
+int parseAffinity(const string& name){
+  for(int i=AFFINITY_NONE; i <= AFFINITY_WAKE; i++){
+    if(name == affinityNames[i] || name == to_string(i)){
+      return i;
+    }
+  }
+  return -1;
+}
+
+}
+
+#endif
@@ -0,0 +1,182 @@
+/* trace.h - Chrome trace-event export of simulated runs
+ *
+ * Each simulated cpu is a track: a process' stay on it is a slice, and
+ * arrivals, preemptions and migrations are instant events, one cycle to a
+ * microsecond. Tracks buffer their events and write them out as they go,
+ * so a long run never sits in memory. chrome://tracing and Perfetto open
+ * the file.
+ *
+ * Environment:
+ *  TRACE_EVENTS - file each run of the menu is written to, replacing
+ *                 the run before
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+#include <cstdio>
+#include <cstdlib>
+
+namespace engine {
+
+using namespace std;
+
+// text as a JSON string, quotes included
+string jsonString(const string& text){
+  string quoted = "\"";
+  for(size_t i=0; i < text.size(); i++){
+    unsigned char c = text[i];
+    if(c == '"' || c == '\\'){
+      quoted += '\\';
+      quoted += c;
+    }else if(c < 0x20){
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      quoted += escaped;
+    }else{
+      quoted += c;
+    }
+  }
+  return quoted + "\"";
+}
+
+// Trace-event file, written to under a lock by any number of tracks
+class TraceEvents{
+public:
+  TraceEvents(const string& path, const string& label){
+    out.open(path.c_str(), ios::trunc);
+    // The metadata event comes first, so every later event starts with a comma
+    out << "{\"traceEvents\":[\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":" << jsonString(label) << "}}";
+  };
+
+  bool ok(){
+    return (bool)out;
+  };
+
+  void write(const string& text){
+    lock_guard<mutex> guard(lock);
+    out << text;
+  };
+
+  void finish(){
+    out << "\n]}" << endl;
+    out.close();
+  };
+
+private:
+  ofstream out;
+  mutex lock;
+};
+
+// Bytes a track gathers before writing them out
+const size_t traceBufferSize = 32768;
+
+// One CPU of a TraceEvents file, written by one thread at a time
+class TraceTrack{
+public:
+  TraceTrack(){
+    events = NULL;
+  };
+
+  TraceTrack(TraceEvents* eventsVal, int idVal, const string& name){
+    events = eventsVal;
+    id = idVal;
+    runningPid = -1;
+    buffer = ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + to_string(id)
+             + ",\"args\":{\"name\":" + jsonString(name) + "}}";
+  };
+
+  void arrive(int pid, int time){
+    instant("arrival", pid, time);
+  };
+
+  void dispatch(int pid, int time){
+    runningPid = pid;
+    runningSince = time;
+  };
+
+  void preempt(int pid, int time){
+    slice(time);
+    instant("preemption", pid, time);
+  };
+
+  void complete(int time){
+    slice(time);
+  };
+
+  void migrate(int pid, int time){
+    instant("migration", pid, time);
+  };
+
+  // Writes out what is buffered, closing the open slice at time
+  void flush(int time){
+    slice(time);
+    events->write(buffer);
+    buffer.clear();
+  };
+
+private:
+  TraceEvents* events;
+  int id;
+  int runningPid;
+  int runningSince;
+  string buffer;
+
+  void append(const char* text){
+    buffer += text;
+    if(buffer.size() >= traceBufferSize){
+      events->write(buffer);
+      buffer.clear();
+    }
+  };
+
+  void instant(const char* name, int pid, int time){
+    char text[160];
+    snprintf(text, sizeof(text), ",\n{\"name\":%s,\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%d,\"args\":{\"pid\":%d}}",
+             jsonString(name).c_str(), id, time, pid);
+    append(text);
+  };
+
+  // Ends the slice of the process on the CPU, if there is one
+  void slice(int time){
+    if(runningPid < 0){
+      return;
+    }
+    char text[160];
+    snprintf(text, sizeof(text), ",\n{\"name\":\"P%d\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%d,\"dur\":%d,\"args\":{\"pid\":%d}}",
+             runningPid, id, runningSince, time - runningSince, runningPid);
+    runningPid = -1;
+    append(text);
+  };
+};
+
+// TRACE_EVENTS file for the runs of the menu, NULL if none is set or it
+// cannot be written
+TraceEvents* openTraceEvents(const string& label){
+  const char* path = getenv("TRACE_EVENTS");
+  if(path == NULL){
+    return NULL;
+  }
+  TraceEvents* trace = new TraceEvents(path, label);
+  if(!trace->ok()){
+    delete trace;
+    return NULL;
+  }
+  return trace;
+}
+
+// Writes out the tracks of a run ending at time and closes trace
+void finishTrace(TraceEvents* trace, vector<TraceTrack>& tracks, int time){
+  for(int i=0; i < (int)tracks.size(); i++){
+    tracks[i].flush(time);
+  }
+  trace->finish();
+  delete trace;
+}
+
+}
+
+#endif
@@ -0,0 +1,282 @@
+/* traceimport.h - workloads from kernel scheduler traces
+ *
+ * Reads `perf sched script` or ftrace sched_switch/sched_wakeup output a
+ * line at a time. Each stretch a task spends runnable, from its wakeup to
+ * the switch where it blocks, becomes a process arriving at the wakeup,
+ * its burst the cpu time it got, in ticks of tickMicros microseconds.
+ * Workload lines are "pid arrival burst priority tid comm".
+ */
+#ifndef TRACEIMPORT_H
+#define TRACEIMPORT_H
+
+#include "engine.h"
+
+namespace engine {
+
+// Trace import
+// A runnable stretch of a task, in nanoseconds so ticks never round short
+class TraceTask{
+public:
+  long long arrival;
+  long long cpu;
+  // Time put on a CPU, -1 while off it
+  long long runningSince;
+  int priority;
+  string comm;
+};
+
+// Time stamp printed just before the event name at pos
+// ("1234.567890: sched_switch:") in nanoseconds, -1 if there is none
+long long traceTime(const string& text, size_t pos){
+  size_t end = pos;
+  if(end >= 6 && text.compare(end - 6, 6, "sched:") == 0){
+    end -= 6;
+  }
+  while(end > 0 && text[end - 1] == ' '){
+    end--;
+  }
+  if(end == 0 || text[end - 1] != ':'){
+    return -1;
+  }
+  size_t start = --end;
+  while(start > 0 && ((text[start - 1] >= '0' && text[start - 1] <= '9') || text[start - 1] == '.')){
+    start--;
+  }
+  if(start == end){
+    return -1;
+  }
+  long long seconds = 0, fraction = 0;
+  int digits = 0;
+  size_t i = start;
+  for(; i < end && text[i] != '.'; i++){
+    seconds = seconds * 10 + (text[i] - '0');
+  }
+  for(i++; i < end && digits < 9; i++, digits++){
+    fraction = fraction * 10 + (text[i] - '0');
+  }
+  for(; digits < 9; digits++){
+    fraction *= 10;
+  }
+  return seconds * 1000000000LL + fraction;
+}
+
+// Value of a key=value field after from
+int traceInt(const string& text, const char* key, size_t from, int fallback){
+  size_t at = text.find(key, from);
+  return at == string::npos?fallback:atoi(text.c_str() + at + strlen(key));
+}
+
+// Text of a key=value field after from, up to next (or the next space),
+// as a comm may hold spaces
+string traceWord(const string& text, const char* key, size_t from, const char* next = " "){
+  size_t at = text.find(key, from);
+  if(at == string::npos){
+    return "";
+  }
+  at += strlen(key);
+  return text.substr(at, text.find(next, at) - at);
+}
+
+// Task written perf's way, "comm:pid [prio]", ending before to
+bool traceCompactTask(const string& text, size_t from, size_t to, string& comm, int& pid, int& priority){
+  size_t bracket = text.rfind(" [", to);
+  if(bracket == string::npos || bracket < from){
+    return false;
+  }
+  size_t colon = text.rfind(':', bracket);
+  if(colon == string::npos || colon < from){
+    return false;
+  }
+  comm = text.substr(from, colon - from);
+  pid = atoi(text.c_str() + colon + 1);
+  priority = atoi(text.c_str() + bracket + 2);
+  return true;
+}
+
+class TraceImport{
+public:
+  // Processes go to out as workload lines and to processes, either may be NULL
+  TraceImport(int tickMicrosVal, ostream* outVal, priority_queue<Process>* processesVal){
+    tickMicros = tickMicrosVal;
+    out = outVal;
+    processes = processesVal;
+    lines = 0;
+    events = 0;
+    jobs = 0;
+    cut = 0;
+    dropped = 0;
+    origin = -1;
+    last = 0;
+    format = "none";
+  };
+
+  long long lines;
+  long long events;
+  long long jobs;
+  long long cut;
+  long long dropped;
+  long long origin;
+  long long last;
+  const char* format;
+
+  // Reads a whole dump and ends the stretches left open
+  void read(istream& is){
+    string text;
+    while(getline(is, text)){
+      lines++;
+      line(text);
+    }
+    for(map<int, TraceTask>::iterator it=tasks.begin(); it != tasks.end(); ++it){
+      if(it->second.runningSince >= 0){
+        it->second.cpu += last - it->second.runningSince;
+      }
+      if(it->second.cpu > 0){
+        cut++;
+        emit(it->first, it->second);
+      }else{
+        dropped++;
+      }
+    }
+    tasks.clear();
+  };
+
+private:
+  int tickMicros;
+  ostream* out;
+  priority_queue<Process>* processes;
+  // Runnable tasks by pid
+  map<int, TraceTask> tasks;
+
+  void line(const string& text){
+    size_t at = text.find("sched_switch: ");
+    bool isSwitch = at != string::npos;
+    if(!isSwitch){
+      at = text.find("sched_wakeup");
+      if(at == string::npos){
+        at = text.find("sched_waking: ");
+      }
+      if(at == string::npos){
+        return;
+      }
+    }
+    long long time = traceTime(text, at);
+    size_t body = text.find(": ", at);
+    if(time < 0 || body == string::npos){
+      return;
+    }
+    body += 2;
+    if(origin < 0){
+      origin = time;
+      format = at >= 6 && text.compare(at - 6, 6, "sched:") == 0?"perf sched script":"ftrace";
+    }
+    last = max(last, time);
+    events++;
+    string comm;
+    int pid, priority;
+    if(!isSwitch){
+      if(text.find("pid=", body) != string::npos){
+        comm = traceWord(text, "comm=", body, " pid=");
+        pid = traceInt(text, " pid=", body, -1);
+        priority = traceInt(text, " prio=", body, 120);
+      }else if(!traceCompactTask(text, body, text.size(), comm, pid, priority)){
+        return;
+      }
+      wakeup(pid, priority, comm, time);
+      return;
+    }
+    string state, nextComm;
+    int nextPid, nextPriority;
+    if(text.find("prev_pid=", body) != string::npos){
+      comm = traceWord(text, "prev_comm=", body, " prev_pid=");
+      pid = traceInt(text, "prev_pid=", body, -1);
+      priority = traceInt(text, "prev_prio=", body, 120);
+      state = traceWord(text, "prev_state=", body);
+      nextComm = traceWord(text, "next_comm=", body, " next_pid=");
+      nextPid = traceInt(text, "next_pid=", body, -1);
+      nextPriority = traceInt(text, "next_prio=", body, 120);
+    }else{
+      size_t arrow = text.find(" ==> ", body);
+      if(arrow == string::npos || !traceCompactTask(text, body, arrow, comm, pid, priority)
+         || !traceCompactTask(text, arrow + 5, text.size(), nextComm, nextPid, nextPriority)){
+        return;
+      }
+      size_t close = text.find("] ", text.rfind(" [", arrow));
+      state = close < arrow?text.substr(close + 2, arrow - close - 2):"";
+    }
+    switchOut(pid, priority, comm, state, time);
+    switchIn(nextPid, nextPriority, nextComm, time);
+  };
+
+  void wakeup(int pid, int priority, const string& comm, long long time){
+    if(pid <= 0 || tasks.count(pid)){
+      return;
+    }
+    TraceTask& task = tasks[pid];
+    task.arrival = time;
+    task.cpu = 0;
+    task.runningSince = -1;
+    task.priority = priority;
+    task.comm = comm;
+  };
+
+  // A task not seen yet has been running since the capture began
+  void switchOut(int pid, int priority, const string& comm, const string& state, long long time){
+    if(pid <= 0){
+      return;
+    }
+    map<int, TraceTask>::iterator it = tasks.find(pid);
+    if(it == tasks.end()){
+      wakeup(pid, priority, comm, origin);
+      it = tasks.find(pid);
+      it->second.runningSince = origin;
+    }
+    TraceTask& task = it->second;
+    if(task.runningSince >= 0){
+      task.cpu += max(0LL, time - task.runningSince);
+      task.runningSince = -1;
+    }
+    if(state.empty() || state[0] != 'R'){
+      emit(pid, task);
+      tasks.erase(it);
+    }
+  };
+
+  // A task put on a CPU without a wakeup seen was runnable all along
+  void switchIn(int pid, int priority, const string& comm, long long time){
+    if(pid <= 0){
+      return;
+    }
+    wakeup(pid, priority, comm, time);
+    TraceTask& task = tasks[pid];
+    task.priority = priority;
+    if(task.comm.empty()){
+      task.comm = comm;
+    }
+    task.runningSince = time;
+  };
+
+  void emit(int tid, const TraceTask& task){
+    long long tick = tickMicros * 1000LL;
+    int arrival = (int)((task.arrival - origin) / tick);
+    int burst = max(1, (int)((task.cpu + tick / 2) / tick));
+    jobs++;
+    if(out != NULL){
+      string comm = task.comm.empty()?"-":task.comm;
+      replace(comm.begin(), comm.end(), ' ', '_');
+      *out << jobs << " " << arrival << " " << burst << " " << task.priority << " " << tid << " " << comm << "\n";
+    }
+    if(processes != NULL){
+      processes->push(Process((int)jobs, arrival, burst, task.priority));
+    }
+  };
+};
+
+void printImportSummary(const TraceImport& import, ostream& os){
+  os << "Imported " << import.jobs << " processes from " << import.lines << " lines (" << import.events
+     << " scheduler events, " << import.format << ") over " << (import.origin < 0?0:(import.last - import.origin) / 1e9)
+     << " s; " << import.cut << " cut at the end of the capture, " << import.dropped << " never ran" << endl;
+}
+
+}
+
+#endif
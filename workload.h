@@ -0,0 +1,296 @@
+/* workload.h - processes and workloads
+ *
+ * The Process every run schedules, the queues holding them, workload files
+ * and the policies, numbered as in the menu.
+ */
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <iostream>
+#include <string>
+#include <queue>
+#include <deque>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iterator>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace engine {
+
+using namespace std;
+
+thread_local bool cheating;
+
+// Define Process class
+class Process{
+protected:
+
+	friend ostream &operator<<(ostream &, const Process &);
+
+
+
+public:
+
+  Process(){
+    home = -1;
+    memory = 0;
+  };
+
+  Process(int pidVal, int arrivalVal, int burstVal, int priorityVal){
+		pid = pidVal;
+		arrival = arrivalVal;
+		enters = arrivalVal;
+		burst = burstVal;
+		priority = priorityVal;
+		completedCycles = 0;
+		wait = 0;
+		firstRun = -1;
+		completion = 0;
+		home = -1;
+		memory = 0;
+	};
+	int pid;
+	int arrival;
+	// Cycle the run admits the process, later than arrival if it migrated
+	int enters;
+	int burst;
+	int priority;
+	int wait;
+	int turnaround;
+	int completedCycles;
+	// Cycle first put on the cpu, -1 until then, and cycle it completed in
+	int firstRun;
+	int completion;
+	// NUMA node holding the process' memory, -1 for none, and the percent
+	// of its burst spent on memory, which runs slower away from home
+	int home;
+	int memory;
+	bool operator< (const Process &aProcess) const{
+	  return arrival > aProcess.arrival;
+	};
+
+  int remainingCycles(){
+	  return burst - completedCycles;
+	};
+
+  int priorityWithWindchill(){
+    return priority - (UseAging()?(wait/5):0);
+	};
+  static void setUseAging(bool yesNo){ cheating = yesNo; };
+  static bool UseAging(){ return cheating; };
+};
+
+// Output for Process class
+ostream& operator<<(ostream& os, const Process &aProcess){
+  os << aProcess.pid << "\t" << aProcess.arrival << "\t" << aProcess.burst << "\t" << aProcess.priority << endl;
+  return os;
+};
+
+// Helper methods for ProcessQueue
+void incrementWait(Process& aProcess){
+  aProcess.wait++;
+}
+bool lessRemainingTime(Process a, Process b){
+  return a.remainingCycles() < b.remainingCycles();
+}
+
+bool lessPriority(Process a, Process b){
+  return a.priorityWithWindchill() < b.priorityWithWindchill();
+}
+
+// ProcessQueue extends Queue to allow access to private iterator
+class ProcessQueue : public queue<Process> {
+public:
+  void incrementWaits(ProcessQueue& aProcessQueue){
+    for_each(aProcessQueue.c.begin(), aProcessQueue.c.end(), incrementWait);
+  };
+
+  void sortByRemainingTime(ProcessQueue& aProcessQueue){
+    sort(aProcessQueue.c.begin(), aProcessQueue.c.end(),lessRemainingTime);
+  };
+
+  void sortByPriority(ProcessQueue& aProcessQueue){
+    sort(aProcessQueue.c.begin(), aProcessQueue.c.end(),lessPriority);
+  };
+
+  deque<Process> contents(ProcessQueue& aProcessQueue){
+    return aProcessQueue.c;
+  };
+
+  // i-th process from the back
+  Process& fromBack(ProcessQueue& aProcessQueue, int i){
+    return aProcessQueue.c[aProcessQueue.c.size() - 1 - i];
+  };
+
+  Process popBack(ProcessQueue& aProcessQueue){
+    Process last = aProcessQueue.c.back();
+    aProcessQueue.c.pop_back();
+    return last;
+  };
+};
+
+// RunQueue is the round robin ready queue: a ring buffer of indices into
+// a table of processes that stay put, so a rotation moves one int and
+// never copies a Process. It grows by doubling and is strictly FIFO.
+class RunQueue{
+public:
+  RunQueue(){
+    head = 0;
+    count = 0;
+  };
+
+  bool empty() const{
+    return count == 0;
+  };
+
+  int size() const{
+    return count;
+  };
+
+  int front() const{
+    return slots[head];
+  };
+
+  int back() const{
+    return at(count - 1);
+  };
+
+  // i-th index from the front
+  int at(int i) const{
+    return slots[(head + i) & (slots.size() - 1)];
+  };
+
+  void push(int index){
+    if(count == (int)slots.size()){
+      grow();
+    }
+    slots[(head + count) & (slots.size() - 1)] = index;
+    count++;
+  };
+
+  void pop(){
+    head = (head + 1) & (slots.size() - 1);
+    count--;
+  };
+
+  void popBack(){
+    count--;
+  };
+
+  void clear(){
+    head = 0;
+    count = 0;
+  };
+
+private:
+  vector<int> slots;
+  int head;
+  int count;
+
+  // Capacity stays a power of two, so wrapping around is a mask
+  void grow(){
+    vector<int> bigger(slots.empty()?16:2 * slots.size());
+    for(int i=0; i < count; i++){
+      bigger[i] = at(i);
+    }
+    slots.swap(bigger);
+    head = 0;
+  };
+};
+
+// Helper method
+template <class T>
+inline string to_string (const T& t){
+  stringstream ss;
+  ss << t;
+  return ss.str();
+}
+
+// Helper method splits on whitespace
+vector<string> getTokens(string str){
+  string buf; // Have a buffer string
+  stringstream ss(str); // Insert the string into a stream
+  vector<string> tokens; // Create vector to hold our words
+  while (ss >> buf)
+  tokens.push_back(buf);
+  return tokens;
+}
+
+// Reads the home=N and memory=P fields a workload line may carry after
+// its first four, leaving the process as it is without them
+void readNumaFields(const string& text, Process& aProcess){
+  const char* field = strstr(text.c_str(), "home=");
+  if(field != NULL){
+    aProcess.home = atoi(field + 5);
+  }
+  field = strstr(text.c_str(), "memory=");
+  if(field != NULL){
+    aProcess.memory = max(0, min(100, atoi(field + 7)));
+  }
+}
+
+// Adds the processes of a workload, one "pid arrival burst priority"
+// per line, to the queue. A "class pid arrival burst priority count
+// interval" line adds count processes, as ProcessClass describes them.
+// Lines with fewer fields are skipped, home=N and memory=P after the
+// four fields place the memory of a process (see readNumaFields()).
+void loadWorkload(istream& is, priority_queue<Process>& processes){
+  string text;
+  while(getline(is,text)){
+    vector<string> tokens = getTokens(text);
+    if(tokens.size() >= 7 && tokens[0] == "class"){
+      long long count = atoll(tokens[5].c_str());
+      long long interval = atoll(tokens[6].c_str());
+      for(long long k=0; k < count; k++){
+        processes.push(Process(atoi(tokens[1].c_str()) + (int)k, (int)(atoll(tokens[2].c_str()) + k * interval),
+                               atoi(tokens[3].c_str()), atoi(tokens[4].c_str())));
+      }
+    }else if(tokens.size() >= 4){
+      Process aProcess(atoi(tokens[0].c_str()),atoi(tokens[1].c_str()),atoi(tokens[2].c_str()),atoi(tokens[3].c_str()));
+      readNumaFields(text, aProcess);
+      processes.push(aProcess);
+    }
+  }
+}
+
+// Whether a run can finish the process: it is admitted in the cycle it
+// arrives and completes once it has run its whole burst
+bool runnable(const Process& aProcess){
+  return aProcess.burst >= 1 && aProcess.arrival >= 0;
+}
+
+// Arrival order of a priority queue, as Simulation pops it
+vector<Process> arrivalOrder(priority_queue<Process> processes){
+  vector<Process> arrivals;
+  while(!processes.empty()){
+    arrivals.push_back(processes.top());
+    processes.pop();
+  }
+  return arrivals;
+}
+
+// Scheduling policies, numbered as in the menu
+enum Policy{
+  POLICY_FCFS = 1,
+  POLICY_SRTF,
+  POLICY_PRIORITY,
+  POLICY_PREEMPTIVE_PRIORITY,
+  POLICY_RR
+};
+
+const char* policyName(int policy){
+  static const char* names[] = {"", "FCFS", "SRTF", "Priority", "Preemptive Priority", "RR"};
+  return (policy >= POLICY_FCFS && policy <= POLICY_RR)?names[policy]:"unknown";
+}
+
+// Hands report output to the ostream in ctx
+void reportToStream(const char* data, size_t n, void* ctx){
+  ((ostream*)ctx)->write(data, n);
+}
+
+}
+
+#endif